@@ -0,0 +1,17 @@
+#version 460 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 frag_color;
+
+layout(set = 1, binding = 1) uniform sampler2D textures[];
+
+layout(push_constant) uniform Draw_Constants
+{
+    uint texture_ix;
+};
+
+void main()
+{
+    vec3 color = vec3(0.7, 0.5, 1.0) * texture(textures[texture_ix], gl_FragCoord.xy / 256.0).rgb;
+    frag_color = vec4(color, 1.0);
+}
@@ -2,3 +2,7 @@
 
 glslangValidator -V -o test.vert.spv test.vert
 glslangValidator -V -o test.frag.spv test.frag
+glslangValidator -V -o bindless.frag.spv bindless.frag
+glslangValidator -V -o test.comp.spv test.comp
+glslangValidator -V -o mesh.vert.spv mesh.vert
+glslangValidator -V -o cull.comp.spv cull.comp
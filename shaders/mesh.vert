@@ -0,0 +1,14 @@
+#version 460 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 instance_offset_scale;
+
+layout(set = 0, binding = 0) uniform Frame_Constants
+{
+    mat4 view_proj;
+};
+
+void main()
+{
+    gl_Position = view_proj * vec4(position * instance_offset_scale.w + instance_offset_scale.xyz, 1.0);
+}
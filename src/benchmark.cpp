@@ -0,0 +1,442 @@
+#include <chrono>
+#include <string.h>
+#include "utils.hpp"
+
+#include "vulkan_context.hpp"
+#include "vulkan_pipeline.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_upload.hpp"
+#include "vulkan_timeline.hpp"
+#include "vulkan_record.hpp"
+#include "vulkan_shader.hpp"
+#include "vulkan_pipeline_manager.hpp"
+#include "vulkan_registry.hpp"
+
+#define EV_BENCH_MAX_RESULTS 64
+#define EV_BENCH_REPEATS 9
+
+struct Bench_Result
+{
+	char name[64];
+	double value;
+	const char* unit;
+};
+
+struct Bench_Context
+{
+	VK_CTX vk_ctx;
+	VkQueue queue;
+	VkRenderPass renderpass;
+	VkPipelineLayout pipeline_layout;
+	VkCommandPool cmd_pool;
+	VkCommandBuffer cmd_buffer;
+	Timeline timeline;
+	Bench_Result results[EV_BENCH_MAX_RESULTS];
+	uint32_t result_count;
+};
+
+static uint32_t bench_width = 512;
+static uint32_t bench_height = 512;
+static uint32_t draw_counts[] = { 1, 100, 1000, 10000 };
+static uint32_t pipeline_worker_count = 4;
+
+static double now_seconds() {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int compare_doubles(const void* a, const void* b) {
+	double da = *(const double*)a;
+	double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+static double median(double* samples, uint32_t count) {
+	qsort(samples, count, sizeof(double), compare_doubles);
+	return samples[count / 2];
+}
+
+static void push_result(Bench_Context* bench, const char* name, double value, const char* unit) {
+	EV_CHECK(bench->result_count < EV_BENCH_MAX_RESULTS);
+	Bench_Result* result = &bench->results[bench->result_count++];
+	snprintf(result->name, sizeof(result->name), "%s", name);
+	result->value = value;
+	result->unit = unit;
+	fprintf(stderr, "%-40s %14.3f %s\n", name, value, unit);
+}
+
+static void submit_and_wait(Bench_Context* bench) {
+	uint64_t value = timeline_advance(&bench->timeline);
+	Semaphore_Point signal = timeline_point(&bench->timeline, value, 0);
+	Queue_Submit submit = {};
+	submit.cmd_buffers = &bench->cmd_buffer;
+	submit.cmd_buffer_count = 1;
+	submit.signals = &signal;
+	submit.signal_count = 1;
+	submit_queue(bench->queue, submit, VK_NULL_HANDLE);
+	timeline_wait(bench->vk_ctx.gpu_if, &bench->timeline, value);
+}
+
+static void bench_resource_creation(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	const uint32_t iterations = 2000;
+
+	BufferBlock* buffers = EV_ALLOC(BufferBlock, iterations);
+	double start = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		buffers[x] = create_bufferblock(gpu_if, 4096 + (x % 16) * 4096, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+		bind_bufferblock(gpu_if, &buffers[x], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+	double created = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		destroy_bufferblock(gpu_if, buffers[x]);
+	}
+	double destroyed = now_seconds();
+	push_result(bench, "bufferblock_create_bind", iterations / (created - start), "ops/s");
+	push_result(bench, "bufferblock_destroy", iterations / (destroyed - created), "ops/s");
+	EV_FREE(buffers);
+
+	ImageBlock* images = EV_ALLOC(ImageBlock, iterations);
+	start = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		uint32_t size = 16u << (x % 5);
+		images[x] = create_imageblock(gpu_if, { size, size, 1 }, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+		bind_imageblock(gpu_if, &images[x], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+	created = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		destroy_imageblock(gpu_if, images[x]);
+	}
+	destroyed = now_seconds();
+	push_result(bench, "imageblock_create_bind", iterations / (created - start), "ops/s");
+	push_result(bench, "imageblock_destroy", iterations / (destroyed - created), "ops/s");
+	EV_FREE(images);
+
+	Resource_Registry registry = create_resource_registry(0, 0);
+	Buffer_Handle* handles = EV_ALLOC(Buffer_Handle, iterations);
+	start = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		handles[x] = registry_create_buffer(gpu_if, &registry, 4096 + (x % 16) * 4096, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+	created = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		registry_destroy_buffer(gpu_if, &registry, handles[x]);
+	}
+	destroyed = now_seconds();
+	push_result(bench, "registry_buffer_create_bind", iterations / (created - start), "ops/s");
+	push_result(bench, "registry_buffer_destroy", iterations / (destroyed - created), "ops/s");
+	EV_FREE(handles);
+	destroy_resource_registry(gpu_if, &registry);
+
+	VkMemoryRequirements requirements = {};
+	requirements.alignment = 256;
+	requirements.memoryTypeBits = UINT32_MAX;
+	Memory_Allocation* allocations = EV_ALLOC(Memory_Allocation, iterations);
+	start = now_seconds();
+	for (uint32_t x = 0; x < iterations; x++) {
+		requirements.size = 256 + (x % 64) * 1024;
+		allocations[x] = allocate_device_memory(gpu_if, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, x % 2 == 0);
+	}
+	for (uint32_t x = 0; x < iterations; x++) {
+		free_device_memory(gpu_if, allocations[x]);
+	}
+	push_result(bench, "device_memory_alloc_free", iterations / (now_seconds() - start), "ops/s");
+	EV_FREE(allocations);
+}
+
+static void bench_pipeline_creation(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	double uncached[EV_BENCH_REPEATS];
+	double warm[EV_BENCH_REPEATS];
+
+	for (uint32_t x = 0; x < EV_BENCH_REPEATS; x++) {
+		double start = now_seconds();
+		VkPipeline pipeline = create_graphics_pipeline(gpu_if, NULL, bench->pipeline_layout, bench->renderpass, NULL,
+			"shaders/test.vert.spv", "shaders/test.frag.spv");
+		uncached[x] = now_seconds() - start;
+		vkDestroyPipeline(gpu_if.device, pipeline, NULL);
+	}
+
+	remove("benchmark.cache");
+	Pipeline_Cache cache = create_pipeline_cache(gpu_if, "benchmark.cache");
+	double start = now_seconds();
+	VkPipeline pipeline = create_graphics_pipeline(gpu_if, &cache, bench->pipeline_layout, bench->renderpass, NULL,
+		"shaders/test.vert.spv", "shaders/test.frag.spv");
+	double cold = now_seconds() - start;
+	vkDestroyPipeline(gpu_if.device, pipeline, NULL);
+	destroy_pipeline_cache(gpu_if, &cache);
+
+	uint32_t hits = 0;
+	size_t loaded_size = 0;
+	for (uint32_t x = 0; x < EV_BENCH_REPEATS; x++) {
+		cache = create_pipeline_cache(gpu_if, "benchmark.cache");
+		loaded_size = cache.loaded_size;
+		start = now_seconds();
+		pipeline = create_graphics_pipeline(gpu_if, &cache, bench->pipeline_layout, bench->renderpass, NULL,
+			"shaders/test.vert.spv", "shaders/test.frag.spv");
+		warm[x] = now_seconds() - start;
+		vkDestroyPipeline(gpu_if.device, pipeline, NULL);
+		hits += cache.hits;
+		destroy_pipeline_cache(gpu_if, &cache);
+	}
+
+	push_result(bench, "pipeline_create_uncached", median(uncached, EV_BENCH_REPEATS) * 1000.0, "ms");
+	push_result(bench, "pipeline_create_cold_cache", cold * 1000.0, "ms");
+	push_result(bench, "pipeline_create_warm_cache", median(warm, EV_BENCH_REPEATS) * 1000.0, "ms");
+	push_result(bench, "pipeline_cache_loaded_bytes", (double)loaded_size, "bytes");
+	push_result(bench, "pipeline_cache_hits", hits, "count");
+	remove("benchmark.cache");
+}
+
+static void bench_pipeline_permutations(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	VkCullModeFlags cull_modes[] = { VK_CULL_MODE_NONE, VK_CULL_MODE_FRONT_BIT, VK_CULL_MODE_BACK_BIT, VK_CULL_MODE_FRONT_AND_BACK };
+	VkFrontFace front_faces[] = { VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_FRONT_FACE_CLOCKWISE };
+	const uint32_t permutation_count = 16;
+
+	Render_Pass_Key pass_key = { VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT };
+	Pipeline_Desc descs[permutation_count];
+	for (uint32_t x = 0; x < permutation_count; x++) {
+		descs[x] = graphics_pipeline_desc(bench->pipeline_layout, bench->renderpass, pass_key, "shaders/test.vert.spv", "shaders/test.frag.spv");
+		descs[x].state.cull_mode = cull_modes[x % 4];
+		descs[x].state.front_face = front_faces[(x / 4) % 2];
+		descs[x].state.blend = x / 8;
+	}
+
+	VkShaderModule vert_module = load_shader_module(gpu_if, "shaders/test.vert.spv");
+	VkShaderModule frag_module = load_shader_module(gpu_if, "shaders/test.frag.spv");
+	VkPipeline pipelines[permutation_count];
+	double start = now_seconds();
+	for (uint32_t x = 0; x < permutation_count; x++) {
+		pipelines[x] = build_graphics_pipeline(gpu_if, NULL, bench->pipeline_layout, bench->renderpass, NULL, &descs[x].state, NULL, vert_module, frag_module);
+	}
+	double serial = now_seconds() - start;
+	for (uint32_t x = 0; x < permutation_count; x++) {
+		vkDestroyPipeline(gpu_if.device, pipelines[x], NULL);
+	}
+	vkDestroyShaderModule(gpu_if.device, vert_module, NULL);
+	vkDestroyShaderModule(gpu_if.device, frag_module, NULL);
+
+	Shader_Library* shaders = create_shader_library(gpu_if, NULL, false);
+	Pipeline_Manager* manager = create_pipeline_manager(gpu_if, NULL, shaders, pipeline_worker_count);
+	Pipeline_Handle handles[permutation_count];
+	start = now_seconds();
+	request_pipelines(manager, descs, permutation_count, EV_PIPELINE_HANDLE_NONE, handles);
+	double request = now_seconds() - start;
+	wait_pipelines(manager);
+	double parallel = now_seconds() - start;
+	request_pipelines(manager, descs, permutation_count, EV_PIPELINE_HANDLE_NONE, handles);
+
+	push_result(bench, "pipeline_permutations_serial", serial * 1000.0, "ms");
+	push_result(bench, "pipeline_permutations_parallel", parallel * 1000.0, "ms");
+	push_result(bench, "pipeline_permutations_request", request * 1000.0, "ms");
+	push_result(bench, "pipeline_permutations_deduped", manager->dedup_count, "count");
+	destroy_pipeline_manager(manager);
+	destroy_shader_library(shaders);
+}
+
+struct Draw_Job
+{
+	VkPipeline pipeline;
+	VkViewport viewport;
+	VkRect2D scissor;
+};
+
+static void record_draw_job(VkCommandBuffer cmd_buffer, uint32_t first, uint32_t count, void* user_data) {
+	Draw_Job* job = (Draw_Job*)user_data;
+	vkCmdSetViewport(cmd_buffer, 0, 1, &job->viewport);
+	vkCmdSetScissor(cmd_buffer, 0, 1, &job->scissor);
+	vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, job->pipeline);
+	for (uint32_t x = 0; x < count; x++) {
+		vkCmdDraw(cmd_buffer, 3, 1, 0, first + x);
+	}
+}
+
+static void begin_bench_pass(Bench_Context* bench, VkSubpassContents contents) {
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	EV_CHECK_VKRESULT(vkResetCommandPool(bench->vk_ctx.gpu_if.device, bench->cmd_pool, 0));
+	EV_CHECK_VKRESULT(vkBeginCommandBuffer(bench->cmd_buffer, &begin_info));
+
+	VkClearValue clear_value = {{0.0, 0.0, 0.0, 1.0}};
+	VkRenderPassBeginInfo renderpass_begin_info = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+	renderpass_begin_info.renderPass = bench->renderpass;
+	renderpass_begin_info.framebuffer = bench->vk_ctx.present.framebuffers[0];
+	renderpass_begin_info.renderArea = { {0, 0}, bench->vk_ctx.present.extent };
+	renderpass_begin_info.clearValueCount = 1;
+	renderpass_begin_info.pClearValues = &clear_value;
+	vkCmdBeginRenderPass(bench->cmd_buffer, &renderpass_begin_info, contents);
+}
+
+static void bench_draws(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	Draw_Job job;
+	job.pipeline = create_graphics_pipeline(gpu_if, NULL, bench->pipeline_layout, bench->renderpass, NULL,
+		"shaders/test.vert.spv", "shaders/test.frag.spv");
+	job.viewport = { 0, (float)bench_height, (float)bench_width, -(float)bench_height, 0.0, 1.0 };
+	job.scissor = { {0, 0}, bench->vk_ctx.present.extent };
+
+	char name[64];
+	for (uint32_t x = 0; x < sizeof(draw_counts) / sizeof(draw_counts[0]); x++) {
+		uint32_t draw_count = draw_counts[x];
+		double gpu[EV_BENCH_REPEATS];
+		double record[EV_BENCH_REPEATS];
+		for (uint32_t y = 0; y < EV_BENCH_REPEATS; y++) {
+			double start = now_seconds();
+			begin_bench_pass(bench, VK_SUBPASS_CONTENTS_INLINE);
+			record_draw_job(bench->cmd_buffer, 0, draw_count, &job);
+			vkCmdEndRenderPass(bench->cmd_buffer);
+			EV_CHECK_VKRESULT(vkEndCommandBuffer(bench->cmd_buffer));
+			double recorded = now_seconds();
+			submit_and_wait(bench);
+			record[y] = recorded - start;
+			gpu[y] = now_seconds() - recorded;
+		}
+
+		snprintf(name, sizeof(name), "triangles_per_sec_%u_draws", draw_count);
+		push_result(bench, name, draw_count / median(gpu, EV_BENCH_REPEATS), "tri/s");
+		snprintf(name, sizeof(name), "record_ns_per_draw_%u_draws", draw_count);
+		push_result(bench, name, median(record, EV_BENCH_REPEATS) * 1e9 / draw_count, "ns");
+	}
+
+	const uint32_t thread_count = 4;
+	const uint32_t draw_count = draw_counts[sizeof(draw_counts) / sizeof(draw_counts[0]) - 1];
+	Record_System* record_system = create_record_system(gpu_if, thread_count, 1);
+	double record[EV_BENCH_REPEATS];
+	for (uint32_t y = 0; y < EV_BENCH_REPEATS; y++) {
+		double start = now_seconds();
+		begin_bench_pass(bench, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		reset_record_frame(record_system, 0);
+		record_parallel(record_system, 0, bench->cmd_buffer, bench->renderpass, bench->vk_ctx.present.framebuffers[0], draw_count, record_draw_job, &job);
+		vkCmdEndRenderPass(bench->cmd_buffer);
+		EV_CHECK_VKRESULT(vkEndCommandBuffer(bench->cmd_buffer));
+		record[y] = now_seconds() - start;
+		submit_and_wait(bench);
+	}
+	snprintf(name, sizeof(name), "record_ns_per_draw_%u_draws_%u_threads", draw_count, thread_count);
+	push_result(bench, name, median(record, EV_BENCH_REPEATS) * 1e9 / draw_count, "ns");
+
+	destroy_record_system(record_system);
+	vkDestroyPipeline(gpu_if.device, job.pipeline, NULL);
+}
+
+static void bench_upload(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	const VkDeviceSize chunk_size = 1024 * 1024;
+	const VkDeviceSize dst_size = 64 * chunk_size;
+	const uint32_t chunk_count = 512;
+
+	Queue_Info transfer = gpu_if.queues[EV_QUEUE_TRANSFER];
+	Upload_Context upload = create_upload_context(gpu_if, transfer, transfer.family, 32 * chunk_size, 2);
+	BufferBlock dst = create_bufferblock(gpu_if, dst_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	bind_bufferblock(gpu_if, &dst, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	uint8_t* data = EV_ALLOC(uint8_t, chunk_size);
+	memset(data, 0x5a, chunk_size);
+
+	double start = now_seconds();
+	for (uint32_t x = 0; x < chunk_count; x++) {
+		upload_buffer(gpu_if, &upload, dst, (x * chunk_size) % dst_size, data, chunk_size);
+		if (x % 8 == 7) flush_uploads(gpu_if, &upload);
+	}
+	flush_uploads(gpu_if, &upload);
+	timeline_wait(gpu_if, &upload.timeline, upload.timeline.value);
+	double elapsed = now_seconds() - start;
+	push_result(bench, "upload_bandwidth", chunk_count * chunk_size / elapsed / (1024.0 * 1024.0), "MiB/s");
+
+	EV_FREE(data);
+	destroy_bufferblock(gpu_if, dst);
+	destroy_upload_context(gpu_if, &upload);
+}
+
+static void bench_defragment(Bench_Context* bench) {
+	GpuIF gpu_if = bench->vk_ctx.gpu_if;
+	const uint32_t buffer_count = 192;
+	const VkDeviceSize buffer_size = 1024 * 1024;
+
+	Resource_Registry registry = create_resource_registry(buffer_count, 0);
+	Deletion_Queue deletions = create_deletion_queue(&bench->timeline);
+	Buffer_Handle* handles = EV_ALLOC(Buffer_Handle, buffer_count);
+	for (uint32_t x = 0; x < buffer_count; x++) {
+		handles[x] = registry_create_buffer(gpu_if, &registry, buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+	for (uint32_t x = 0; x < buffer_count; x++) {
+		if (x % 3) registry_destroy_buffer(gpu_if, &registry, handles[x]);
+	}
+	uint32_t blocks_before = gpu_if.allocator->device_allocation_count;
+
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	uint32_t step_count = 0;
+	uint32_t moved_count = 0;
+	double start = now_seconds();
+	for (;;) {
+		EV_CHECK_VKRESULT(vkResetCommandPool(gpu_if.device, bench->cmd_pool, 0));
+		EV_CHECK_VKRESULT(vkBeginCommandBuffer(bench->cmd_buffer, &begin_info));
+		uint32_t moved = registry_defragment(gpu_if, &registry, bench->cmd_buffer, &deletions, 8 * buffer_size, NULL, 0);
+		EV_CHECK_VKRESULT(vkEndCommandBuffer(bench->cmd_buffer));
+		submit_and_wait(bench);
+		flush_deletions(gpu_if, &deletions);
+		step_count++;
+		if (moved == 0) break;
+		moved_count += moved;
+	}
+	double elapsed = now_seconds() - start;
+	push_result(bench, "defrag_ms_per_step", elapsed * 1000.0 / step_count, "ms");
+	push_result(bench, "defrag_buffers_moved", moved_count, "buffers");
+	push_result(bench, "defrag_device_allocations_released", blocks_before - gpu_if.allocator->device_allocation_count, "allocations");
+
+	EV_FREE(handles);
+	destroy_deletion_queue(gpu_if, &deletions);
+	destroy_resource_registry(gpu_if, &registry);
+}
+
+static bool write_results(Bench_Context* bench, const char* path) {
+	FILE* fptr = stdout;
+	if (path) {
+		EV_FOPEN(fptr, path, "w");
+		if (!fptr) return false;
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(bench->vk_ctx.gpu_if.gpu, &properties);
+	fprintf(fptr, "{\n\t\"device\": \"%s\",\n\t\"driver_version\": %u,\n\t\"results\": [\n", properties.deviceName, properties.driverVersion);
+	for (uint32_t x = 0; x < bench->result_count; x++) {
+		Bench_Result* result = &bench->results[x];
+		fprintf(fptr, "\t\t{ \"name\": \"%s\", \"value\": %.6f, \"unit\": \"%s\" }%s\n",
+			result->name, result->value, result->unit, x + 1 < bench->result_count ? "," : "");
+	}
+	fprintf(fptr, "\t]\n}\n");
+	return path ? fclose(fptr) == 0 : true;
+}
+
+int main(int argc, char** argv) {
+	Bench_Context bench = {};
+	vulkan_context_init_headless(&bench.vk_ctx, { bench_width, bench_height }, 1);
+	GpuIF gpu_if = bench.vk_ctx.gpu_if;
+	bench.queue = gpu_if.queues[EV_QUEUE_GRAPHICS].queue;
+
+	bench.renderpass = create_renderpass(gpu_if, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	create_framebuffers(gpu_if, bench.renderpass, &bench.vk_ctx.present);
+	bench.pipeline_layout = create_pipeline_layout(gpu_if, NULL, 0, NULL, 0);
+	bench.cmd_pool = create_command_pool(gpu_if, gpu_if.queues[EV_QUEUE_GRAPHICS].family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	VkCommandBuffer* cmd_buffers = allocate_command_buffers(gpu_if, bench.cmd_pool, 1);
+	bench.cmd_buffer = *cmd_buffers;
+	EV_FREE(cmd_buffers);
+	bench.timeline = create_timeline(gpu_if);
+
+	bench_resource_creation(&bench);
+	bench_pipeline_creation(&bench);
+	bench_pipeline_permutations(&bench);
+	bench_draws(&bench);
+	bench_upload(&bench);
+	bench_defragment(&bench);
+
+	bool written = write_results(&bench, argc > 1 ? argv[1] : NULL);
+
+	destroy_timeline(gpu_if, &bench.timeline);
+	vkDestroyCommandPool(gpu_if.device, bench.cmd_pool, NULL);
+	vkDestroyPipelineLayout(gpu_if.device, bench.pipeline_layout, NULL);
+	vkDestroyRenderPass(gpu_if.device, bench.renderpass, NULL);
+	vulkan_context_terminate(&bench.vk_ctx);
+	return written ? 0 : 1;
+}
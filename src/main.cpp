@@ -1,18 +1,51 @@
+#include <string.h>
 #include "utils.hpp"
 
 #include "vulkan_context.hpp"
 #include "vulkan_pipeline.hpp"
 #include "vulkan_resource.hpp"
+#include "vulkan_readback.hpp"
+#include "vulkan_upload.hpp"
+#include "vulkan_frame.hpp"
+#include "vulkan_record.hpp"
+#include "vulkan_profiler.hpp"
+#include "vulkan_compute.hpp"
+#include "vulkan_descriptor.hpp"
+#include "vulkan_mesh.hpp"
+#include "vulkan_cull.hpp"
+#include "vulkan_queue.hpp"
+#include "vulkan_timeline.hpp"
+#include "vulkan_deletion.hpp"
+#include "vulkan_shader.hpp"
+#include "vulkan_graph.hpp"
+#include "vulkan_arena.hpp"
+#include "vulkan_texture.hpp"
+#include "vulkan_registry.hpp"
+#include "vulkan_capture.hpp"
 
 static bool running;
+static bool resized;
 static uint32_t width = 1400;
 static uint32_t height = 900;
+static uint32_t frames_in_flight = 2;
+static VkPresentModeKHR present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+static uint32_t record_thread_count = 4;
+static uint32_t instance_grid = 64;
+static bool hot_reload_shaders = true;
+
+#ifdef EV_HEADLESS
+static uint32_t headless_image_count = 3;
+static uint32_t headless_frame_count = 600;
+#else
 LRESULT CALLBACK window_proc(HWND window, UINT msg, WPARAM w_param, LPARAM l_param) {
 	switch (msg) {
 		case WM_DESTROY: {
 			running = false;
 			PostQuitMessage(0);
-		}
+		} break;
+		case WM_SIZE: {
+			resized = true;
+		} break;
 	}
 	return DefWindowProc(window, msg, w_param, l_param);
 }
@@ -23,111 +56,564 @@ void handle_message(MSG* msg) {
 		DispatchMessage(msg);
 	}
 }
+#endif
 
 struct vec3 { float x, y, z; };
 struct Vertex { vec3 pos; };
+struct Instance { vec3 offset; float scale; };
+
+struct Frame_Constants
+{
+	float view_proj[16];
+};
+
+struct Draw_State
+{
+	GpuIF gpu_if;
+	VkPipeline pipeline;
+	VkPipelineLayout layout;
+	Gpu_Arena* constants;
+	VkDeviceSize constants_offset;
+	VkViewport viewport;
+	VkRect2D scissor;
+	Mesh_Pool* meshes;
+	VkBuffer instances;
+	Draw_List* draws;
+	bool use_draw_count;
+	Bindless_Table* bindless;
+	uint32_t texture_ix;
+};
+
+struct Frame_Passes
+{
+	GpuIF gpu_if;
+	Profiler* profiler;
+	Cull_Context* cull;
+	Compute_Batch* compute_batch;
+	Gpu_Arena* constants;
+	const float* view_proj;
+	BufferBlock* cull_buffer;
+	uint32_t instance_count;
+	Draw_List* draw_list;
+	Draw_State* draw_state;
+	Record_System* record_system;
+	uint32_t frame_ix;
+	VkImage image;
+	VkExtent2D extent;
+	VkImage scene;
+	VkExtent2D scene_extent;
+	Capture_Stream* capture;
+	uint32_t capture_slot;
+#ifdef EV_HEADLESS
+	Readback_Ring* readback;
+	uint32_t img_ix;
+#endif
+};
+
+struct Scale_Params
+{
+	float scale;
+	float bias;
+	uint32_t count;
+};
+
+void scale_reference(void** buffers, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z) {
+	const float* src = (const float*)buffers[0];
+	float* dst = (float*)buffers[1];
+	const Scale_Params* params = (const Scale_Params*)push_constants;
+	for (uint32_t x = 0; x < group_x * 64 && x < params->count; x++) {
+		dst[x] = src[x] * params->scale + params->bias;
+	}
+}
+
+void record_draws(VkCommandBuffer cmd_buffer, uint32_t first, uint32_t count, void* user_data) {
+	Draw_State* state = (Draw_State*)user_data;
+	vkCmdSetViewport(cmd_buffer, 0, 1, &state->viewport);
+	vkCmdSetScissor(cmd_buffer, 0, 1, &state->scissor);
+	vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, state->pipeline);
+	bind_gpu_arena(state->constants, cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, state->layout, 0, state->constants_offset);
+	if (state->bindless) {
+		bind_bindless_table(state->bindless, cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, state->layout, 1);
+		vkCmdPushConstants(cmd_buffer, state->layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &state->texture_ix);
+	}
+	bind_mesh_buffers(cmd_buffer, state->meshes, state->instances);
+
+	if (state->use_draw_count) record_mesh_draws_count(state->gpu_if, cmd_buffer, state->draws);
+	else record_mesh_draws(state->gpu_if, cmd_buffer, state->draws, first, count);
+}
+
+void record_cull_pass(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data) {
+	Frame_Passes* passes = (Frame_Passes*)user_data;
+	gpu_scope_begin(passes->profiler, cmd_buffer, "cull");
+	begin_compute_batch(passes->compute_batch, cmd_buffer, false);
+	record_cull(passes->gpu_if, passes->cull, passes->compute_batch, passes->constants, passes->view_proj, passes->cull_buffer, passes->instance_count, passes->draw_list);
+	gpu_scope_end(passes->profiler, cmd_buffer);
+}
 
-int main() {
-	MSG msg = {}; 
+void record_main_pass(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data) {
+	Frame_Passes* passes = (Frame_Passes*)user_data;
+	uint32_t record_item_count = passes->draw_state->use_draw_count ? 1 : passes->draw_list->draw_count;
+	gpu_scope_begin(passes->profiler, cmd_buffer, "main_pass");
+	record_parallel(passes->record_system, passes->frame_ix, cmd_buffer, context->renderpass, context->framebuffer, record_item_count, record_draws, passes->draw_state);
+	gpu_scope_end(passes->profiler, cmd_buffer);
+}
+
+void record_blit_pass(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data) {
+	Frame_Passes* passes = (Frame_Passes*)user_data;
+	gpu_scope_begin(passes->profiler, cmd_buffer, "blit");
+	VkImageBlit region = {};
+	region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.srcOffsets[1] = { (int32_t)passes->scene_extent.width, (int32_t)passes->scene_extent.height, 1 };
+	region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.dstOffsets[1] = { (int32_t)passes->extent.width, (int32_t)passes->extent.height, 1 };
+	vkCmdBlitImage(cmd_buffer, passes->scene, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, passes->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, VK_FILTER_LINEAR);
+	gpu_scope_end(passes->profiler, cmd_buffer);
+}
+
+#ifdef EV_HEADLESS
+void record_readback_pass(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data) {
+	Frame_Passes* passes = (Frame_Passes*)user_data;
+	gpu_scope_begin(passes->profiler, cmd_buffer, "readback");
+	record_image_readback(passes->readback, passes->img_ix, cmd_buffer, passes->image, passes->extent);
+	gpu_scope_end(passes->profiler, cmd_buffer);
+}
+#endif
+
+void record_capture_pass(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data) {
+	Frame_Passes* passes = (Frame_Passes*)user_data;
+	if (passes->capture_slot == EV_CAPTURE_NONE) return;
+	gpu_scope_begin(passes->profiler, cmd_buffer, "capture");
+	record_capture(passes->capture, passes->capture_slot, cmd_buffer, passes->image, passes->extent);
+	gpu_scope_end(passes->profiler, cmd_buffer);
+}
+
+int main(int argc, char** argv) {
 	VK_CTX vk_ctx;
+#ifdef EV_HEADLESS
+	vulkan_context_init_headless(&vk_ctx, { width, height }, headless_image_count);
+	VkRenderPass renderpass = create_renderpass(vk_ctx.gpu_if, vk_ctx.present.format.format, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+#else
 	HWND window = create_win32_window(window_proc, width, height);
-	vulkan_context_init(&vk_ctx, window);
+	vulkan_context_init(&vk_ctx, window, present_mode);
+	VkRenderPass renderpass = create_renderpass(vk_ctx.gpu_if, vk_ctx.present.format.format, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+#endif
 
-	VkRenderPass renderpass = create_renderpass(vk_ctx.gpu_if);
 	create_framebuffers(vk_ctx.gpu_if, renderpass, &vk_ctx.present);
 	uint32_t image_count = vk_ctx.present.image_count;
 
-	BufferBlock block0 = create_bufferblock(vk_ctx.gpu_if, 16, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-	BufferBlock block1 = create_bufferblock(vk_ctx.gpu_if, 16, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	Queue_Info graphics = vk_ctx.gpu_if.queues[EV_QUEUE_GRAPHICS];
+	Queue_Info compute = vk_ctx.gpu_if.queues[EV_QUEUE_COMPUTE];
+	VkQueue queue = graphics.queue;
+	Upload_Context upload = create_upload_context(vk_ctx.gpu_if, vk_ctx.gpu_if.queues[EV_QUEUE_TRANSFER], graphics.family, 4 * 1024 * 1024, frames_in_flight);
 
-	VkDeviceSize size = 128 * 1024 * 1024;
-	VkDeviceMemory host_visible_chuck = allocate_memory(vk_ctx.gpu_if, size, block0.requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	Resource_Registry registry = create_resource_registry(64, 64);
+	Buffer_Handle block0_handle = registry_create_buffer(vk_ctx.gpu_if, &registry, 16, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	Buffer_Handle block1_handle = registry_create_buffer(vk_ctx.gpu_if, &registry, 16, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	BufferBlock block0 = registry_buffer_block(&registry, block0_handle);
+	BufferBlock block1 = registry_buffer_block(&registry, block1_handle);
 
-	vkBindBufferMemory(vk_ctx.gpu_if.device, block0.buffer, host_visible_chuck, 0);
-	vkBindBufferMemory(vk_ctx.gpu_if.device, block1.buffer, host_visible_chuck, block0.requirements.size);
+	float block0_data[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+	upload_buffer(vk_ctx.gpu_if, &upload, block0, 0, block0_data, sizeof(block0_data));
 
-	VkPipelineLayout pipeline_layout = create_pipeline_layout(vk_ctx.gpu_if);
-	VkPipeline gfx_pipeline = create_graphics_pipeline(vk_ctx.gpu_if, pipeline_layout, renderpass,
-		"shaders//test.vert.spv", "shaders/test.frag.spv");
+	Texture_Desc checker_desc = {};
+	checker_desc.format = VK_FORMAT_R8G8B8A8_UNORM;
+	checker_desc.extent = { 256, 256 };
+	checker_desc.generate_mips = true;
+	Texture checker = create_texture(vk_ctx.gpu_if, checker_desc);
+	uint32_t* checker_texels = (uint32_t*)stage_texture_level(vk_ctx.gpu_if, &upload, &checker, 0, 0, 1);
+	for (uint32_t x = 0; x < 256 * 256; x++) {
+		checker_texels[x] = ((x % 256) / 32 + (x / 256) / 32) % 2 ? 0xFFFFFFFF : 0xFF000000;
+	}
+	VkSampler checker_sampler = create_texture_sampler(vk_ctx.gpu_if, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, checker.mip_count);
+
+	Vertex triangle_vertices[] = { {-0.5f, -0.5f, 0.0f}, {0.0f, 0.5f, 0.0f}, {0.5f, -0.5f, 0.0f} };
+	uint16_t triangle_indices[] = { 0, 1, 2 };
+	Vertex quad_vertices[] = { {-0.5f, -0.5f, 0.0f}, {-0.5f, 0.5f, 0.0f}, {0.5f, 0.5f, 0.0f}, {0.5f, -0.5f, 0.0f} };
+	uint16_t quad_indices[] = { 0, 1, 2, 0, 2, 3 };
+
+	Mesh_Pool mesh_pool = create_mesh_pool(vk_ctx.gpu_if, sizeof(Vertex), 1 << 16, VK_INDEX_TYPE_UINT16, 1 << 18);
+	uint32_t triangle_mesh = add_mesh(vk_ctx.gpu_if, &mesh_pool, &upload, triangle_vertices, 3, triangle_indices, 3);
+	uint32_t quad_mesh = add_mesh(vk_ctx.gpu_if, &mesh_pool, &upload, quad_vertices, 4, quad_indices, 6);
+
+	uint32_t instance_count = instance_grid * instance_grid;
+	Instance* instances = EV_ALLOC(Instance, instance_count);
+	float cell = 2.0f / instance_grid;
+	for (uint32_t x = 0; x < instance_count; x++) {
+		instances[x].offset = { -1.0f + cell * (x % instance_grid + 0.5f), -1.0f + cell * (x / instance_grid + 0.5f), 0.0f };
+		instances[x].scale = cell * 0.8f;
+	}
+	Cull_Instance* cull_instances = EV_ALLOC(Cull_Instance, instance_count);
+	for (uint32_t x = 0; x < instance_count; x++) {
+		cull_instances[x] = {};
+		cull_instances[x].center[0] = instances[x].offset.x;
+		cull_instances[x].center[1] = instances[x].offset.y;
+		cull_instances[x].center[2] = instances[x].offset.z;
+		cull_instances[x].radius = instances[x].scale * 0.71f;
+		cull_instances[x].mesh_ix = x < instance_count / 2 ? triangle_mesh : quad_mesh;
+	}
+	BufferBlock instance_buffer = create_instance_buffer(vk_ctx.gpu_if, &upload, instances, sizeof(Instance), instance_count);
+	BufferBlock cull_buffer = create_instance_buffer(vk_ctx.gpu_if, &upload, cull_instances, sizeof(Cull_Instance), instance_count);
+	EV_FREE(instances);
+	EV_FREE(cull_instances);
+	Draw_List draw_list = create_draw_list(vk_ctx.gpu_if, instance_count);
 
-	VkCommandPool cmd_pool = create_command_pool(vk_ctx.gpu_if);
-	VkCommandBuffer* cmd_buffers = allocate_command_buffers(vk_ctx.gpu_if, cmd_pool, image_count);
+	Frame_Scheduler scheduler = create_frame_scheduler(vk_ctx.gpu_if, frames_in_flight, image_count);
+	Frame_Arena scratch = create_frame_arena(64 * 1024);
+	Gpu_Arena frame_constants = create_gpu_arena(vk_ctx.gpu_if, &scheduler.timeline, 64 * 1024, frames_in_flight);
+
+	Vertex_Layout vertex_layout = {};
+	add_vertex_binding(&vertex_layout, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
+	add_vertex_attribute(&vertex_layout, VK_FORMAT_R32G32B32_SFLOAT, 0);
+	add_vertex_binding(&vertex_layout, sizeof(Instance), VK_VERTEX_INPUT_RATE_INSTANCE);
+	add_vertex_attribute(&vertex_layout, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+
+	bool use_bindless = vk_ctx.gpu_if.features & EV_FEATURE_DESCRIPTOR_INDEXING;
+	Bindless_Table bindless = {};
+	uint32_t checker_ix = EV_BINDLESS_INVALID;
+	if (use_bindless) {
+		bindless = create_bindless_table(vk_ctx.gpu_if, &scheduler.timeline, 1024, 1024);
+		bindless_add_buffer(vk_ctx.gpu_if, &bindless, block0.buffer, 0, VK_WHOLE_SIZE);
+		bindless_add_buffer(vk_ctx.gpu_if, &bindless, block1.buffer, 0, VK_WHOLE_SIZE);
+		checker_ix = bindless_add_texture(vk_ctx.gpu_if, &bindless, checker.view, checker_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	VkDescriptorSetLayout set_layouts[] = { frame_constants.set_layout, bindless.layout };
+	VkPushConstantRange texture_range = { VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t) };
+	VkPipelineLayout pipeline_layout = use_bindless ? create_pipeline_layout(vk_ctx.gpu_if, set_layouts, 2, &texture_range, 1)
+		: create_pipeline_layout(vk_ctx.gpu_if, set_layouts, 1, NULL, 0);
+	Pipeline_Cache pipeline_cache = create_pipeline_cache(vk_ctx.gpu_if, "pipeline.cache");
+	Shader_Library* shaders = create_shader_library(vk_ctx.gpu_if, &pipeline_cache, hot_reload_shaders);
+	Shader_Pipeline* mesh_pipeline = create_library_graphics_pipeline(shaders, pipeline_layout, renderpass, &vertex_layout,
+		"shaders/mesh.vert.spv", use_bindless ? "shaders/bindless.frag.spv" : "shaders/test.frag.spv");
+
+	VkCommandPool cmd_pools[EV_MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer cmd_buffers[EV_MAX_FRAMES_IN_FLIGHT];
+	for (uint32_t x = 0; x < frames_in_flight; x++) {
+		cmd_pools[x] = create_command_pool(vk_ctx.gpu_if, graphics.family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		VkCommandBuffer* cmd_buffer = allocate_command_buffers(vk_ctx.gpu_if, cmd_pools[x], 1);
+		cmd_buffers[x] = *cmd_buffer;
+		EV_FREE(cmd_buffer);
+	}
+	Record_System* record_system = create_record_system(vk_ctx.gpu_if, record_thread_count, frames_in_flight);
+	Profiler profiler = create_profiler(vk_ctx.gpu_if, graphics.family, frames_in_flight, 16384);
+
+	Compute_Desc scale_desc = {};
+	scale_desc.shader_file = "shaders/test.comp.spv";
+	scale_desc.bindings[0] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, false };
+	scale_desc.bindings[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, true };
+	scale_desc.binding_count = 2;
+	scale_desc.push_constant_size = sizeof(Scale_Params);
+	scale_desc.reference = scale_reference;
+	Compute_Kernel scale_kernel = create_compute_kernel(vk_ctx.gpu_if, &pipeline_cache, scale_desc);
+	Descriptor_Allocator descriptors = create_descriptor_allocator(vk_ctx.gpu_if, frames_in_flight, 64);
+	Compute_Batch compute_batch = create_compute_batch(&descriptors, &scratch);
+	Cull_Context cull = create_cull_context(vk_ctx.gpu_if, &pipeline_cache, &mesh_pool, &upload);
+	float view_proj[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	Scale_Params scale_params = { 2.0f, 0.5f, 4 };
+	Compute_Resource scale_resources[] = { { &block0, 0, VK_WHOLE_SIZE }, { &block1, 0, VK_WHOLE_SIZE } };
+	VkCommandBufferBeginInfo compute_begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	compute_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VkCommandPool compute_pool = create_command_pool(vk_ctx.gpu_if, compute.family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	VkCommandBuffer* compute_cmd_buffer = allocate_command_buffers(vk_ctx.gpu_if, compute_pool, 1);
+	Deletion_Queue deletions = create_deletion_queue(&scheduler.timeline);
+	Timeline compute_timeline = create_timeline(vk_ctx.gpu_if);
+
+	flush_uploads(vk_ctx.gpu_if, &upload);
+	EV_CHECK_VKRESULT(vkBeginCommandBuffer(cmd_buffers[0], &compute_begin_info));
+	Semaphore_Point upload_wait;
+	Queue_Submit handoff_submit = {};
+	handoff_submit.wait_count = record_upload_acquires(&upload, cmd_buffers[0], &upload_wait);
+	record_texture_mips(cmd_buffers[0], &checker);
+	handoff_submit.waits = &upload_wait;
+	release_buffer_ownership(cmd_buffers[0], block0.buffer, 0, VK_WHOLE_SIZE, graphics.family, compute.family, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0);
+	EV_CHECK_VKRESULT(vkEndCommandBuffer(cmd_buffers[0]));
+	handoff_submit.cmd_buffers = &cmd_buffers[0];
+	handoff_submit.cmd_buffer_count = 1;
+	Semaphore_Point handoff = timeline_point(&scheduler.timeline, timeline_advance(&scheduler.timeline), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	handoff_submit.signals = &handoff;
+	handoff_submit.signal_count = 1;
+	submit_queue(graphics.queue, handoff_submit, VK_NULL_HANDLE);
+
+	EV_CHECK_VKRESULT(vkBeginCommandBuffer(*compute_cmd_buffer, &compute_begin_info));
+	acquire_buffer_ownership(*compute_cmd_buffer, block0.buffer, 0, VK_WHOLE_SIZE, graphics.family, compute.family, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	begin_compute_batch(&compute_batch, *compute_cmd_buffer, false);
+	record_dispatch(vk_ctx.gpu_if, &compute_batch, &scale_kernel, scale_resources, &scale_params, 1, 1, 1);
+	registry_use_buffer(&registry, block0_handle);
+	registry_use_buffer(&registry, block1_handle);
+	end_compute_batch(&compute_batch, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+	release_buffer_ownership(*compute_cmd_buffer, block1.buffer, 0, VK_WHOLE_SIZE, compute.family, graphics.family, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+	EV_CHECK_VKRESULT(vkEndCommandBuffer(*compute_cmd_buffer));
+
+	Semaphore_Point compute_done = timeline_point(&compute_timeline, timeline_advance(&compute_timeline), 0);
+	Queue_Submit compute_submit = {};
+	compute_submit.cmd_buffers = compute_cmd_buffer;
+	compute_submit.cmd_buffer_count = 1;
+	compute_submit.waits = &handoff;
+	compute_submit.wait_count = 1;
+	compute_submit.signals = &compute_done;
+	compute_submit.signal_count = 1;
+	submit_queue(compute.queue, compute_submit, VK_NULL_HANDLE);
+	timeline_wait(vk_ctx.gpu_if, &compute_timeline, compute_done.value);
+	vkDestroyCommandPool(vk_ctx.gpu_if.device, compute_pool, NULL);
+
+	if (compute.family != graphics.family) {
+		EV_CHECK_VKRESULT(vkResetCommandPool(vk_ctx.gpu_if.device, cmd_pools[0], 0));
+		EV_CHECK_VKRESULT(vkBeginCommandBuffer(cmd_buffers[0], &compute_begin_info));
+		acquire_buffer_ownership(cmd_buffers[0], block1.buffer, 0, VK_WHOLE_SIZE, compute.family, graphics.family, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+		EV_CHECK_VKRESULT(vkEndCommandBuffer(cmd_buffers[0]));
+		Semaphore_Point compute_wait = timeline_point(&compute_timeline, compute_done.value, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		Semaphore_Point acquired = timeline_point(&scheduler.timeline, timeline_advance(&scheduler.timeline), 0);
+		Queue_Submit acquire_submit = {};
+		acquire_submit.cmd_buffers = &cmd_buffers[0];
+		acquire_submit.cmd_buffer_count = 1;
+		acquire_submit.waits = &compute_wait;
+		acquire_submit.wait_count = 1;
+		acquire_submit.signals = &acquired;
+		acquire_submit.signal_count = 1;
+		submit_queue(graphics.queue, acquire_submit, VK_NULL_HANDLE);
+		timeline_wait(vk_ctx.gpu_if, &scheduler.timeline, acquired.value);
+	}
+	EV_FREE(compute_cmd_buffer);
+
+	float scale_expected[4];
+	void* reference_buffers[] = { block0_data, scale_expected };
+	run_compute_reference(&scale_kernel, reference_buffers, &scale_params, 1, 1, 1);
+	bool compute_matches = memcmp(block1.allocation.mapped, scale_expected, sizeof(scale_expected)) == 0;
+	printf("compute: %s reference\n", compute_matches ? "matches" : "differs from");
+
+#ifdef EV_HEADLESS
+	VkDeviceSize frame_size = (VkDeviceSize)vk_ctx.present.extent.width * vk_ctx.present.extent.height * 4;
+	Readback_Ring readback = create_readback_ring(vk_ctx.gpu_if, frame_size, image_count);
+	uint32_t frames_read = 0;
+#else
+	MSG msg = {};
+#endif
 
 	uint32_t scr_width = vk_ctx.present.extent.width;
 	uint32_t scr_height = vk_ctx.present.extent.height;
 	VkCommandBufferBeginInfo cmd_buffer_begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
-	VkRenderPassBeginInfo renderpass_begin_info = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
-	renderpass_begin_info.renderPass = renderpass;
-	renderpass_begin_info.renderArea = { {0, 0}, {scr_width, scr_height} };
-	renderpass_begin_info.clearValueCount = 1;
+	cmd_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	VkClearValue clear_value = {{0.0, 0.0, 0.0, 1.0}};
-	renderpass_begin_info.pClearValues = &clear_value;
-
-	VkRect2D scissor = { {0, 0}, vk_ctx.present.extent };
-	VkViewport viewport = {0, (float)scr_height, (float)scr_width, -(float)scr_height, 0.0, 1.0};
-	for (uint32_t x = 0; x < image_count; x++) {
-		renderpass_begin_info.framebuffer = vk_ctx.present.framebuffers[x];
-		EV_CHECK_VKRESULT(vkBeginCommandBuffer(cmd_buffers[x], &cmd_buffer_begin_info));
 
-		vkCmdBeginRenderPass(cmd_buffers[x], &renderpass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+	Draw_State draw_state;
+	draw_state.gpu_if = vk_ctx.gpu_if;
+	draw_state.pipeline = mesh_pipeline->pipeline;
+	draw_state.layout = pipeline_layout;
+	draw_state.constants = &frame_constants;
+	draw_state.scissor = { {0, 0}, vk_ctx.present.extent };
+	draw_state.viewport = {0, (float)scr_height, (float)scr_width, -(float)scr_height, 0.0, 1.0};
+	draw_state.meshes = &mesh_pool;
+	draw_state.instances = instance_buffer.buffer;
+	draw_state.draws = &draw_list;
+	draw_state.use_draw_count = vk_ctx.gpu_if.features & EV_FEATURE_DRAW_INDIRECT_COUNT;
+	draw_state.bindless = use_bindless ? &bindless : NULL;
+	draw_state.texture_ix = checker_ix;
 
-		vkCmdSetViewport(cmd_buffers[x], 0, 1, &viewport);
-		vkCmdSetScissor(cmd_buffers[x], 0, 1, &scissor);
+	Frame_Passes frame_passes = {};
+	frame_passes.gpu_if = vk_ctx.gpu_if;
+	frame_passes.profiler = &profiler;
+	frame_passes.cull = &cull;
+	frame_passes.compute_batch = &compute_batch;
+	frame_passes.constants = &frame_constants;
+	frame_passes.view_proj = view_proj;
+	frame_passes.cull_buffer = &cull_buffer;
+	frame_passes.instance_count = instance_count;
+	frame_passes.draw_list = &draw_list;
+	frame_passes.draw_state = &draw_state;
+	frame_passes.record_system = record_system;
+	frame_passes.capture_slot = EV_CAPTURE_NONE;
+	if (argc > 1 && (vk_ctx.present.usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)) {
+		frame_passes.capture = create_capture_stream(vk_ctx.gpu_if, argv[1], capture_format_from_path(argv[1]), EV_CAPTURE_DROP, vk_ctx.present.format.format,
+			vk_ctx.present.extent, frames_in_flight + 1);
+	}
 
-		vkCmdBindPipeline(cmd_buffers[x], VK_PIPELINE_BIND_POINT_GRAPHICS, gfx_pipeline);
+	Render_Graph* graph = create_render_graph(vk_ctx.gpu_if);
+#ifdef EV_HEADLESS
+	frame_passes.readback = &readback;
+	Graph_Resource backbuffer = graph_import_image(graph, "backbuffer", vk_ctx.present.format.format, vk_ctx.present.extent,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+#else
+	Graph_Resource backbuffer = graph_import_image(graph, "backbuffer", vk_ctx.present.format.format, vk_ctx.present.extent,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+#endif
+	Graph_Resource draw_commands = graph_import_buffer(graph, "draw_commands", draw_list.commands.buffer, 0, VK_WHOLE_SIZE, false);
+	Graph_Resource draw_count = graph_import_buffer(graph, "draw_count", draw_list.count.buffer, 0, VK_WHOLE_SIZE, false);
 
-		vkCmdDraw(cmd_buffers[x], 3, 1, 0, 0);
+	Graph_Pass cull_pass = graph_add_pass(graph, "cull", EV_GRAPH_PASS_COMPUTE, record_cull_pass, &frame_passes);
+	graph_use(graph, cull_pass, draw_commands, EV_GRAPH_STORAGE_WRITE);
+	graph_use(graph, cull_pass, draw_count, EV_GRAPH_STORAGE_WRITE);
 
-		vkCmdEndRenderPass(cmd_buffers[x]);
-		vkEndCommandBuffer(cmd_buffers[x]);
+	bool use_scene = vk_ctx.present.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	Graph_Resource scene = use_scene ? graph_create_image(graph, "scene", { vk_ctx.present.extent, vk_ctx.present.format.format }) : backbuffer;
+	Graph_Pass main_pass = graph_add_pass(graph, "main_pass", EV_GRAPH_PASS_RASTER, record_main_pass, &frame_passes);
+	graph_attachment(graph, main_pass, scene, VK_ATTACHMENT_LOAD_OP_CLEAR, clear_value);
+	graph_use(graph, main_pass, draw_commands, EV_GRAPH_INDIRECT);
+	graph_use(graph, main_pass, draw_count, EV_GRAPH_INDIRECT);
+	graph_secondary_contents(graph, main_pass);
+	if (use_scene) {
+		Graph_Pass blit_pass = graph_add_pass(graph, "blit", EV_GRAPH_PASS_TRANSFER, record_blit_pass, &frame_passes);
+		graph_use(graph, blit_pass, scene, EV_GRAPH_TRANSFER_SRC);
+		graph_use(graph, blit_pass, backbuffer, EV_GRAPH_TRANSFER_DST);
 	}
+#ifdef EV_HEADLESS
+	Graph_Pass readback_pass = graph_add_pass(graph, "readback", EV_GRAPH_PASS_TRANSFER, record_readback_pass, &frame_passes);
+	graph_use(graph, readback_pass, backbuffer, EV_GRAPH_TRANSFER_SRC);
+	graph_side_effects(graph, readback_pass);
+#endif
+	if (frame_passes.capture) {
+		Graph_Pass capture_pass = graph_add_pass(graph, "capture", EV_GRAPH_PASS_TRANSFER, record_capture_pass, &frame_passes);
+		graph_use(graph, capture_pass, backbuffer, EV_GRAPH_TRANSFER_SRC);
+		graph_side_effects(graph, capture_pass);
+	}
+	compile_render_graph(graph);
+	frame_passes.scene = graph->resources[scene].image;
+	frame_passes.scene_extent = graph->resources[scene].extent;
 
-	VkSemaphore image_acquired_sem = create_semaphore(vk_ctx.gpu_if);
-	VkSemaphore render_complete_sem = create_semaphore(vk_ctx.gpu_if);
-	VkFence* wait_fences = create_fences(vk_ctx.gpu_if, image_count);
-
-	VkQueue queue;
-	vkGetDeviceQueue(vk_ctx.gpu_if.device, 0, 0, &queue);
-
-	uint32_t img_ix;
 	running = true;
+#ifndef EV_HEADLESS
+	resized = false;
+#endif
 	while (running) {
+#ifndef EV_HEADLESS
 		handle_message(&msg);
+		if (resized || scheduler.swapchain_dirty) {
+			if (!recreate_swapchain(&vk_ctx, renderpass, &deletions)) {
+				WaitMessage();
+				continue;
+			}
+			resize_frame_images(vk_ctx.gpu_if, &scheduler, vk_ctx.present.image_count);
+			resized = false;
+			scheduler.swapchain_dirty = false;
+			scr_width = vk_ctx.present.extent.width;
+			scr_height = vk_ctx.present.extent.height;
+			reset_graph_framebuffers(graph, &deletions);
+			if (frame_passes.capture) resize_capture_stream(frame_passes.capture, vk_ctx.present.extent);
+			if (!use_scene) {
+				draw_state.scissor = { {0, 0}, vk_ctx.present.extent };
+				draw_state.viewport = {0, (float)scr_height, (float)scr_width, -(float)scr_height, 0.0, 1.0};
+			}
+		}
+#endif
+		cpu_scope_begin(&profiler, "acquire");
+		if (!begin_frame(vk_ctx.gpu_if, &scheduler, &vk_ctx.present)) {
+			cpu_scope_end(&profiler);
+			continue;
+		}
+		uint32_t frame_ix = scheduler.frame_ix;
+		uint32_t img_ix = scheduler.image_ix;
+		VkCommandBuffer cmd_buffer = cmd_buffers[frame_ix];
+		reset_descriptor_frame(vk_ctx.gpu_if, &descriptors, frame_ix);
+		reset_frame_arena(&scratch);
+		begin_gpu_arena_frame(vk_ctx.gpu_if, &frame_constants, frame_ix);
+		flush_deletions(vk_ctx.gpu_if, &deletions);
+		update_memory_budget(vk_ctx.gpu_if);
+		if (apply_shader_reloads(shaders, &deletions)) draw_state.pipeline = mesh_pipeline->pipeline;
+		cpu_scope_end(&profiler);
+
+		flush_uploads(vk_ctx.gpu_if, &upload);
+#ifdef EV_HEADLESS
+		if (fetch_readback(vk_ctx.gpu_if, &readback, img_ix)) frames_read++;
+#endif
+
+		cpu_scope_begin(&profiler, "record");
+		EV_CHECK_VKRESULT(vkResetCommandPool(vk_ctx.gpu_if.device, cmd_pools[frame_ix], 0));
+		reset_record_frame(record_system, frame_ix);
+		EV_CHECK_VKRESULT(vkBeginCommandBuffer(cmd_buffer, &cmd_buffer_begin_info));
+		uint32_t upload_wait_count = record_upload_acquires(&upload, cmd_buffer, &upload_wait);
+		profiler_begin_frame(vk_ctx.gpu_if, &profiler, frame_ix, scheduler.frame_number, cmd_buffer);
+		begin_registry_frame(&registry, scheduler.frame_number);
 
-		EV_CHECK_VKRESULT(vkAcquireNextImageKHR(vk_ctx.gpu_if.device, vk_ctx.present.swapchain, INT64_MAX, image_acquired_sem, VK_NULL_HANDLE, &img_ix));
-
-		EV_CHECK_VKRESULT(vkWaitForFences(vk_ctx.gpu_if.device, 1, &wait_fences[img_ix], VK_TRUE, INT64_MAX));
-		EV_CHECK_VKRESULT(vkResetFences(vk_ctx.gpu_if.device, 1, &wait_fences[img_ix]));
-
-		VkPipelineStageFlags wait_mask[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
-		submit_info.pWaitDstStageMask = wait_mask;
-		submit_info.waitSemaphoreCount = 1;
-		submit_info.pWaitSemaphores = &image_acquired_sem;
-		submit_info.signalSemaphoreCount = 1;
-		submit_info.pSignalSemaphores = &render_complete_sem;
-		submit_info.commandBufferCount = 1;
-		submit_info.pCommandBuffers = &cmd_buffers[img_ix];
-		EV_CHECK_VKRESULT(vkQueueSubmit(queue, 1, &submit_info, wait_fences[img_ix]));
-
-		VkPresentInfoKHR present_info = {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
-		present_info.swapchainCount = 1;
-		present_info.pSwapchains = &vk_ctx.present.swapchain;
-		present_info.pImageIndices = &img_ix;
-		present_info.waitSemaphoreCount = 1;
-		present_info.pWaitSemaphores = &render_complete_sem;
-		EV_CHECK_VKRESULT(vkQueuePresentKHR(queue, &present_info));
+		Arena_Slice constants_slice = gpu_arena_push(&frame_constants, sizeof(Frame_Constants));
+		memcpy(((Frame_Constants*)constants_slice.mapped)->view_proj, view_proj, sizeof(view_proj));
+		draw_state.constants_offset = constants_slice.offset;
+		frame_passes.frame_ix = frame_ix;
+		frame_passes.image = vk_ctx.present.images[img_ix];
+		frame_passes.extent = vk_ctx.present.extent;
+		if (frame_passes.capture) frame_passes.capture_slot = begin_capture(frame_passes.capture, scheduler.frame_number);
+#ifdef EV_HEADLESS
+		frame_passes.img_ix = img_ix;
+#endif
+		graph_set_image(graph, backbuffer, vk_ctx.present.images[img_ix], vk_ctx.present.views[img_ix], vk_ctx.present.extent);
+		execute_render_graph(graph, cmd_buffer);
+		EV_CHECK_VKRESULT(vkEndCommandBuffer(cmd_buffer));
+		cpu_scope_end(&profiler);
+
+		cpu_scope_begin(&profiler, "submit");
+		uint64_t frame_value = submit_frame(&scheduler, &vk_ctx.present, queue, &cmd_buffer, 1, &upload_wait, upload_wait_count);
+		end_gpu_arena_frame(&frame_constants, frame_value);
+		if (frame_passes.capture_slot != EV_CAPTURE_NONE) submit_capture(frame_passes.capture, frame_passes.capture_slot, &scheduler.timeline, frame_value);
+		profiler_submit_frame(&profiler);
+		cpu_scope_end(&profiler);
+
+		cpu_scope_begin(&profiler, "present");
+		present_frame(&scheduler, &vk_ctx.present, queue);
+		cpu_scope_end(&profiler);
+#ifdef EV_HEADLESS
+		submit_readback(&readback, img_ix, &scheduler.timeline, frame_value);
+		running = scheduler.frame_number < headless_frame_count;
+#endif
 	}
 	vkDeviceWaitIdle(vk_ctx.gpu_if.device);
+	flush_profiler(vk_ctx.gpu_if, &profiler);
+	if (frame_passes.capture) {
+		flush_capture(frame_passes.capture);
+		printf("capture: %llu frames captured, %llu written, %llu dropped, %llu failed\n", (unsigned long long)frame_passes.capture->captured,
+			(unsigned long long)frame_passes.capture->written, (unsigned long long)frame_passes.capture->dropped, (unsigned long long)frame_passes.capture->failed);
+		destroy_capture_stream(frame_passes.capture);
+	}
 
-	vkDestroySemaphore(vk_ctx.gpu_if.device, image_acquired_sem, NULL);
-	vkDestroySemaphore(vk_ctx.gpu_if.device, render_complete_sem, NULL);
+#ifdef EV_HEADLESS
 	for (uint32_t x = 0; x < image_count; x++) {
-		vkDestroyFence(vk_ctx.gpu_if.device, wait_fences[x], NULL);
+		if (fetch_readback(vk_ctx.gpu_if, &readback, x)) frames_read++;
+	}
+	printf("rendered %llu frames, read back %u\n", (unsigned long long)scheduler.frame_number, frames_read);
+	destroy_readback_ring(vk_ctx.gpu_if, &readback);
+	printf("pipeline cache: loaded %zu bytes, %u pipelines, %u hits, %u misses\n",
+		pipeline_cache.loaded_size, pipeline_cache.pipeline_count, pipeline_cache.hits, pipeline_cache.misses);
+	printf("frame arenas: cpu high water %zu bytes, gpu high water %llu bytes\n", scratch.high_water, (unsigned long long)frame_constants.high_water);
+	Registry_Stats registry_usage = registry_stats(&registry, frames_in_flight);
+	printf("registry: %u buffers (%llu bytes), %u images (%llu bytes), %llu bytes idle\n", registry_usage.buffer_count, (unsigned long long)registry_usage.buffer_bytes,
+		registry_usage.image_count, (unsigned long long)registry_usage.image_bytes, (unsigned long long)registry_usage.idle_bytes);
+	if (!write_memory_stats(vk_ctx.gpu_if, "memory_stats.json")) printf("failed to write memory_stats.json\n");
+#endif
+	float p50_ms, p99_ms;
+	if (get_pass_percentiles(&profiler, "main_pass", &p50_ms, &p99_ms)) {
+		printf("main_pass gpu: p50 %.3f ms, p99 %.3f ms\n", p50_ms, p99_ms);
 	}
+	export_chrome_trace(&profiler, "profile.json");
+	destroy_render_graph(graph);
+	destroy_profiler(vk_ctx.gpu_if, &profiler);
+	destroy_cull_context(vk_ctx.gpu_if, &cull);
+	destroy_compute_batch(&compute_batch);
+	destroy_frame_arena(&scratch);
+	if (use_bindless) destroy_bindless_table(vk_ctx.gpu_if, &bindless);
+	destroy_descriptor_allocator(vk_ctx.gpu_if, &descriptors);
+	destroy_compute_kernel(vk_ctx.gpu_if, &scale_kernel);
+
+	destroy_deletion_queue(vk_ctx.gpu_if, &deletions);
+	destroy_gpu_arena(vk_ctx.gpu_if, &frame_constants);
+	destroy_frame_scheduler(vk_ctx.gpu_if, &scheduler);
+	destroy_timeline(vk_ctx.gpu_if, &compute_timeline);
+	destroy_record_system(record_system);
+	destroy_upload_context(vk_ctx.gpu_if, &upload);
+	registry_destroy_buffer(vk_ctx.gpu_if, &registry, block0_handle);
+	registry_destroy_buffer(vk_ctx.gpu_if, &registry, block1_handle);
+	destroy_resource_registry(vk_ctx.gpu_if, &registry);
+	destroy_draw_list(vk_ctx.gpu_if, &draw_list);
+	destroy_bufferblock(vk_ctx.gpu_if, instance_buffer);
+	destroy_bufferblock(vk_ctx.gpu_if, cull_buffer);
+	destroy_mesh_pool(vk_ctx.gpu_if, &mesh_pool);
+	vkDestroySampler(vk_ctx.gpu_if.device, checker_sampler, NULL);
+	destroy_texture(vk_ctx.gpu_if, &checker);
 	vkDestroyPipelineLayout(vk_ctx.gpu_if.device, pipeline_layout, NULL);
-	vkDestroyPipeline(vk_ctx.gpu_if.device, gfx_pipeline, NULL);
+	destroy_shader_library(shaders);
+	destroy_pipeline_cache(vk_ctx.gpu_if, &pipeline_cache);
 	vkDestroyRenderPass(vk_ctx.gpu_if.device, renderpass, NULL);
-	vkDestroyCommandPool(vk_ctx.gpu_if.device, cmd_pool, NULL);
+	for (uint32_t x = 0; x < frames_in_flight; x++) {
+		vkDestroyCommandPool(vk_ctx.gpu_if.device, cmd_pools[x], NULL);
+	}
 	vulkan_context_terminate(&vk_ctx);
-}
\ No newline at end of file
+}
@@ -11,5 +11,14 @@
 #define EV_CHECK_VKRESULT(x)\
 {assert(x == VK_SUCCESS);}
 
-#define EV_ALLOC(t, s) (t*)malloc(sizeof(t) * s)
+#define EV_ALLOC(t, s) (t*)malloc(sizeof(t) * (s))
+#define EV_REALLOC(t, p, s) (t*)realloc(p, sizeof(t) * (s))
 #define EV_FREE(t) free(t)
+
+#define EV_ALIGN_UP(x, a) ((((x) + (a) - 1) / (a)) * (a))
+
+#ifdef _MSC_VER
+#define EV_FOPEN(f, name, mode) fopen_s(&f, name, mode)
+#else
+#define EV_FOPEN(f, name, mode) (f = fopen(name, mode))
+#endif
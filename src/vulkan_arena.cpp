@@ -0,0 +1,136 @@
+#include "vulkan_arena.hpp"
+
+Frame_Arena create_frame_arena(size_t capacity) {
+	Frame_Arena arena = {};
+	arena.capacity = capacity;
+	arena.base = EV_ALLOC(uint8_t, capacity);
+	return arena;
+}
+
+void destroy_frame_arena(Frame_Arena* arena) {
+	for (uint32_t x = 0; x < arena->overflow_count; x++) {
+		EV_FREE(arena->overflow[x]);
+	}
+	EV_FREE(arena->overflow);
+	EV_FREE(arena->base);
+}
+
+void* arena_push(Frame_Arena* arena, size_t size, size_t alignment) {
+	arena->used += size;
+	if (arena->used > arena->high_water) arena->high_water = arena->used;
+
+	size_t offset = EV_ALIGN_UP(arena->head, alignment);
+	if (offset + size <= arena->capacity) {
+		arena->head = offset + size;
+		return arena->base + offset;
+	}
+
+	if (arena->overflow_count == arena->overflow_capacity) {
+		arena->overflow_capacity = arena->overflow_capacity ? arena->overflow_capacity * 2 : 8;
+		arena->overflow = EV_REALLOC(void*, arena->overflow, arena->overflow_capacity);
+	}
+	void* block = EV_ALLOC(uint8_t, size);
+	arena->overflow[arena->overflow_count++] = block;
+	return block;
+}
+
+void reset_frame_arena(Frame_Arena* arena) {
+	for (uint32_t x = 0; x < arena->overflow_count; x++) {
+		EV_FREE(arena->overflow[x]);
+	}
+	if (arena->overflow_count) {
+		arena->capacity = EV_ALIGN_UP(arena->high_water * 2, 4096);
+		arena->base = EV_REALLOC(uint8_t, arena->base, arena->capacity);
+	}
+	arena->overflow_count = 0;
+	arena->head = 0;
+	arena->used = 0;
+}
+
+Gpu_Arena create_gpu_arena(GpuIF gpu_if, Timeline* timeline, VkDeviceSize capacity, uint32_t frame_count) {
+	EV_CHECK(frame_count > 0 && frame_count <= EV_MAX_FRAMES_IN_FLIGHT);
+	Gpu_Arena arena = {};
+	arena.frame_count = frame_count;
+	arena.timeline = timeline;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu_if.gpu, &properties);
+	VkDeviceSize uniform_alignment = properties.limits.minUniformBufferOffsetAlignment;
+	VkDeviceSize storage_alignment = properties.limits.minStorageBufferOffsetAlignment;
+	arena.alignment = uniform_alignment > storage_alignment ? uniform_alignment : storage_alignment;
+	if (arena.alignment < 16) arena.alignment = 16;
+	arena.capacity = EV_ALIGN_UP(capacity, arena.alignment);
+
+	VkDescriptorSetLayoutBinding binding = {};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+	VkDescriptorSetLayoutCreateInfo set_layout_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	set_layout_create_info.bindingCount = 1;
+	set_layout_create_info.pBindings = &binding;
+	EV_CHECK_VKRESULT(vkCreateDescriptorSetLayout(gpu_if.device, &set_layout_create_info, NULL, &arena.set_layout));
+
+	VkDescriptorPoolSize pool_size = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, frame_count };
+	VkDescriptorPoolCreateInfo pool_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	pool_create_info.maxSets = frame_count;
+	pool_create_info.poolSizeCount = 1;
+	pool_create_info.pPoolSizes = &pool_size;
+	EV_CHECK_VKRESULT(vkCreateDescriptorPool(gpu_if.device, &pool_create_info, NULL, &arena.pool));
+
+	for (uint32_t x = 0; x < frame_count; x++) {
+		Gpu_Arena_Frame* frame = &arena.frames[x];
+		frame->buffer = create_bufferblock(gpu_if, arena.capacity + EV_GPU_ARENA_UNIFORM_RANGE, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+		bind_bufferblock(gpu_if, &frame->buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		VkDescriptorSetAllocateInfo set_allocate_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+		set_allocate_info.descriptorPool = arena.pool;
+		set_allocate_info.descriptorSetCount = 1;
+		set_allocate_info.pSetLayouts = &arena.set_layout;
+		EV_CHECK_VKRESULT(vkAllocateDescriptorSets(gpu_if.device, &set_allocate_info, &frame->set));
+
+		VkDescriptorBufferInfo buffer_info = { frame->buffer.buffer, 0, EV_GPU_ARENA_UNIFORM_RANGE };
+		VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		write.dstSet = frame->set;
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		write.pBufferInfo = &buffer_info;
+		vkUpdateDescriptorSets(gpu_if.device, 1, &write, 0, NULL);
+	}
+	return arena;
+}
+
+void destroy_gpu_arena(GpuIF gpu_if, Gpu_Arena* arena) {
+	for (uint32_t x = 0; x < arena->frame_count; x++) {
+		destroy_bufferblock(gpu_if, arena->frames[x].buffer);
+	}
+	vkDestroyDescriptorPool(gpu_if.device, arena->pool, NULL);
+	vkDestroyDescriptorSetLayout(gpu_if.device, arena->set_layout, NULL);
+}
+
+void begin_gpu_arena_frame(GpuIF gpu_if, Gpu_Arena* arena, uint32_t frame_ix) {
+	EV_CHECK(frame_ix < arena->frame_count);
+	timeline_wait(gpu_if, arena->timeline, arena->frames[frame_ix].value);
+	arena->frame_ix = frame_ix;
+	arena->head = 0;
+}
+
+void end_gpu_arena_frame(Gpu_Arena* arena, uint64_t value) {
+	arena->frames[arena->frame_ix].value = value;
+	if (arena->head > arena->high_water) arena->high_water = arena->head;
+}
+
+Arena_Slice gpu_arena_push(Gpu_Arena* arena, VkDeviceSize size) {
+	EV_CHECK(arena->head + size <= arena->capacity);
+	Gpu_Arena_Frame* frame = &arena->frames[arena->frame_ix];
+	Arena_Slice slice = { &frame->buffer, arena->head, frame->buffer.allocation.mapped + arena->head };
+	arena->head = EV_ALIGN_UP(arena->head + size, arena->alignment);
+	return slice;
+}
+
+void bind_gpu_arena(Gpu_Arena* arena, VkCommandBuffer cmd_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set_index, VkDeviceSize offset) {
+	uint32_t dynamic_offset = (uint32_t)offset;
+	vkCmdBindDescriptorSets(cmd_buffer, bind_point, layout, set_index, 1, &arena->frames[arena->frame_ix].set, 1, &dynamic_offset);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_timeline.hpp"
+#include "vulkan_frame.hpp"
+
+#define EV_ARENA_ALLOC(a, t, s) (t*)arena_push(a, sizeof(t) * (s), alignof(t))
+#define EV_GPU_ARENA_UNIFORM_RANGE 256
+
+struct Frame_Arena
+{
+	uint8_t* base;
+	size_t capacity;
+	size_t head;
+	size_t used;
+	size_t high_water;
+	void** overflow;
+	uint32_t overflow_count;
+	uint32_t overflow_capacity;
+};
+
+struct Arena_Slice
+{
+	BufferBlock* block;
+	VkDeviceSize offset;
+	uint8_t* mapped;
+};
+
+struct Gpu_Arena_Frame
+{
+	BufferBlock buffer;
+	VkDescriptorSet set;
+	uint64_t value;
+};
+
+struct Gpu_Arena
+{
+	Gpu_Arena_Frame frames[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t frame_count;
+	uint32_t frame_ix;
+	Timeline* timeline;
+	VkDescriptorSetLayout set_layout;
+	VkDescriptorPool pool;
+	VkDeviceSize capacity;
+	VkDeviceSize alignment;
+	VkDeviceSize head;
+	VkDeviceSize high_water;
+};
+
+Frame_Arena create_frame_arena(size_t capacity);
+void destroy_frame_arena(Frame_Arena* arena);
+void* arena_push(Frame_Arena* arena, size_t size, size_t alignment);
+void reset_frame_arena(Frame_Arena* arena);
+
+Gpu_Arena create_gpu_arena(GpuIF gpu_if, Timeline* timeline, VkDeviceSize capacity, uint32_t frame_count);
+void destroy_gpu_arena(GpuIF gpu_if, Gpu_Arena* arena);
+void begin_gpu_arena_frame(GpuIF gpu_if, Gpu_Arena* arena, uint32_t frame_ix);
+void end_gpu_arena_frame(Gpu_Arena* arena, uint64_t value);
+Arena_Slice gpu_arena_push(Gpu_Arena* arena, VkDeviceSize size);
+void bind_gpu_arena(Gpu_Arena* arena, VkCommandBuffer cmd_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set_index, VkDeviceSize offset);
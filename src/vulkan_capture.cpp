@@ -0,0 +1,352 @@
+#include <string.h>
+#include "vulkan_capture.hpp"
+
+#define EV_PNG_STORED_BLOCK 65535
+
+struct Crc_Table
+{
+	uint32_t entries[256];
+};
+
+static Crc_Table build_crc_table() {
+	Crc_Table table;
+	for (uint32_t x = 0; x < 256; x++) {
+		uint32_t crc = x;
+		for (uint32_t y = 0; y < 8; y++) crc = crc & 1 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+		table.entries[x] = crc;
+	}
+	return table;
+}
+
+static uint32_t update_crc(uint32_t crc, const uint8_t* data, size_t size) {
+	static const Crc_Table table = build_crc_table();
+	for (size_t x = 0; x < size; x++) crc = table.entries[(crc ^ data[x]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+static void put_be32(uint8_t* dst, uint32_t value) {
+	dst[0] = (uint8_t)(value >> 24);
+	dst[1] = (uint8_t)(value >> 16);
+	dst[2] = (uint8_t)(value >> 8);
+	dst[3] = (uint8_t)value;
+}
+
+static size_t png_row_bytes(uint32_t width, uint32_t height) {
+	return (size_t)height * (1 + (size_t)width * 3);
+}
+
+static size_t png_zlib_bytes(size_t raw_size) {
+	size_t block_count = (raw_size + EV_PNG_STORED_BLOCK - 1) / EV_PNG_STORED_BLOCK;
+	return 2 + raw_size + block_count * 5 + 4;
+}
+
+static void convert_rows(Capture_Stream* stream, const Capture_Slot* slot, bool filter_bytes) {
+	uint32_t r = stream->swizzle ? 2 : 0;
+	uint32_t b = stream->swizzle ? 0 : 2;
+	uint8_t* dst = stream->rows;
+	for (uint32_t y = 0; y < slot->extent.height; y++) {
+		const uint8_t* src = slot->pixels + (size_t)y * slot->extent.width * 4;
+		if (filter_bytes) *dst++ = 0;
+		for (uint32_t x = 0; x < slot->extent.width; x++, src += 4) {
+			*dst++ = src[r];
+			*dst++ = src[1];
+			*dst++ = src[b];
+		}
+	}
+}
+
+static bool write_png_chunk(FILE* fptr, const char* type, const uint8_t* data, size_t size) {
+	uint8_t header[8];
+	put_be32(header, (uint32_t)size);
+	memcpy(header + 4, type, 4);
+	uint32_t crc = update_crc(0xFFFFFFFF, header + 4, 4);
+	crc = update_crc(crc, data, size) ^ 0xFFFFFFFF;
+	uint8_t footer[4];
+	put_be32(footer, crc);
+	return fwrite(header, 1, 8, fptr) == 8 && fwrite(data, 1, size, fptr) == size && fwrite(footer, 1, 4, fptr) == 4;
+}
+
+static bool write_png(Capture_Stream* stream, const Capture_Slot* slot, FILE* fptr) {
+	convert_rows(stream, slot, true);
+	size_t raw_size = png_row_bytes(slot->extent.width, slot->extent.height);
+
+	uint8_t* dst = stream->encoded;
+	*dst++ = 0x78;
+	*dst++ = 0x01;
+	uint32_t adler_a = 1, adler_b = 0;
+	for (size_t offset = 0; offset < raw_size; offset += EV_PNG_STORED_BLOCK) {
+		uint32_t size = (uint32_t)(raw_size - offset < EV_PNG_STORED_BLOCK ? raw_size - offset : EV_PNG_STORED_BLOCK);
+		*dst++ = offset + size == raw_size;
+		*dst++ = (uint8_t)size;
+		*dst++ = (uint8_t)(size >> 8);
+		*dst++ = (uint8_t)~size;
+		*dst++ = (uint8_t)(~size >> 8);
+		memcpy(dst, stream->rows + offset, size);
+		for (uint32_t x = 0; x < size; x++) {
+			adler_a = (adler_a + dst[x]) % 65521;
+			adler_b = (adler_b + adler_a) % 65521;
+		}
+		dst += size;
+	}
+	put_be32(dst, (adler_b << 16) | adler_a);
+	dst += 4;
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	uint8_t ihdr[13] = {};
+	put_be32(ihdr, slot->extent.width);
+	put_be32(ihdr + 4, slot->extent.height);
+	ihdr[8] = 8;
+	ihdr[9] = 2;
+	return fwrite(signature, 1, 8, fptr) == 8 && write_png_chunk(fptr, "IHDR", ihdr, sizeof(ihdr)) &&
+		write_png_chunk(fptr, "IDAT", stream->encoded, dst - stream->encoded) && write_png_chunk(fptr, "IEND", NULL, 0);
+}
+
+static bool write_ppm(Capture_Stream* stream, const Capture_Slot* slot, FILE* fptr) {
+	convert_rows(stream, slot, false);
+	size_t size = (size_t)slot->extent.width * slot->extent.height * 3;
+	return fprintf(fptr, "P6\n%u %u\n255\n", slot->extent.width, slot->extent.height) > 0 && fwrite(stream->rows, 1, size, fptr) == size;
+}
+
+static bool write_raw(Capture_Stream* stream, const Capture_Slot* slot) {
+	uint32_t header[4] = { (uint32_t)slot->frame, (uint32_t)(slot->frame >> 32), slot->extent.width, slot->extent.height };
+	size_t size = (size_t)slot->extent.width * slot->extent.height * 4;
+	return fwrite(header, sizeof(header), 1, stream->raw_file) == 1 && fwrite(slot->pixels, 1, size, stream->raw_file) == size;
+}
+
+static bool write_capture_frame(Capture_Stream* stream, const Capture_Slot* slot) {
+	if (stream->format == EV_CAPTURE_RAW) return stream->raw_file && write_raw(stream, slot);
+
+	char path[EV_CAPTURE_PATH_SIZE + 32];
+	snprintf(path, sizeof(path), "%s_%06llu.%s", stream->path, (unsigned long long)slot->frame, stream->format == EV_CAPTURE_PNG ? "png" : "ppm");
+	FILE* fptr;
+	EV_FOPEN(fptr, path, "wb");
+	if (!fptr) return false;
+	bool written = stream->format == EV_CAPTURE_PNG ? write_png(stream, slot, fptr) : write_ppm(stream, slot, fptr);
+	return fclose(fptr) == 0 && written;
+}
+
+static uint32_t hand_off_completed(Capture_Stream* stream);
+
+static uint64_t oldest_submitted(Capture_Stream* stream) {
+	uint64_t oldest = 0;
+	for (uint32_t x = 0; x < stream->ring.slot_count; x++) {
+		uint64_t value = stream->ring.values[x];
+		if (stream->slots[x].state == EV_CAPTURE_SLOT_GPU && value && (!oldest || value < oldest)) oldest = value;
+	}
+	return oldest;
+}
+
+static void capture_writer_main(Capture_Stream* stream) {
+	for (;;) {
+		uint32_t slot_ix;
+		uint64_t wait_value = 0;
+		{
+			std::unique_lock<std::mutex> lock(stream->mutex);
+			stream->work_cv.wait(lock, [&] { return stream->quit || stream->pending_count || stream->submitted; });
+			hand_off_completed(stream);
+			if (stream->pending_count == 0) {
+				if (stream->submitted == 0) return;
+				wait_value = oldest_submitted(stream);
+			}
+			else {
+				slot_ix = stream->pending[stream->pending_head];
+				stream->pending_head = (stream->pending_head + 1) % stream->ring.slot_count;
+				stream->pending_count--;
+			}
+		}
+		if (wait_value) {
+			timeline_wait(stream->gpu_if, stream->ring.timeline, wait_value);
+			continue;
+		}
+
+		bool written = write_capture_frame(stream, &stream->slots[slot_ix]);
+
+		{
+			std::lock_guard<std::mutex> lock(stream->mutex);
+			stream->slots[slot_ix].state = EV_CAPTURE_SLOT_FREE;
+			if (written) stream->written++;
+			else stream->failed++;
+		}
+		stream->free_cv.notify_all();
+	}
+}
+
+Capture_Format capture_format_from_path(const char* path) {
+	const char* extension = strrchr(path, '.');
+	if (extension && strcmp(extension, ".png") == 0) return EV_CAPTURE_PNG;
+	if (extension && strcmp(extension, ".ppm") == 0) return EV_CAPTURE_PPM;
+	return EV_CAPTURE_RAW;
+}
+
+Capture_Stream* create_capture_stream(GpuIF gpu_if, const char* path, Capture_Format format, Capture_Policy policy, VkFormat image_format, VkExtent2D max_extent,
+	uint32_t slot_count) {
+	EV_CHECK(slot_count > 0 && strlen(path) < EV_CAPTURE_PATH_SIZE);
+	bool is_bgra = image_format == VK_FORMAT_B8G8R8A8_UNORM || image_format == VK_FORMAT_B8G8R8A8_SRGB;
+	bool is_rgba = image_format == VK_FORMAT_R8G8B8A8_UNORM || image_format == VK_FORMAT_R8G8B8A8_SRGB;
+	EV_CHECK(is_bgra || is_rgba);
+
+	Capture_Stream* stream = new Capture_Stream();
+	stream->gpu_if = gpu_if;
+	stream->ring = create_readback_ring(gpu_if, (VkDeviceSize)max_extent.width * max_extent.height * 4, slot_count);
+	stream->slots = EV_ALLOC(Capture_Slot, slot_count);
+	stream->pending = EV_ALLOC(uint32_t, slot_count);
+	for (uint32_t x = 0; x < slot_count; x++) stream->slots[x] = { EV_CAPTURE_SLOT_FREE };
+	stream->format = format;
+	stream->policy = policy;
+	stream->swizzle = is_bgra;
+
+	if (format == EV_CAPTURE_RAW) {
+		size_t path_size = strlen(path);
+		memcpy(stream->path, path, path_size + 1);
+		char extension[] = ".evcap";
+		bool has_extension = strchr(path, '.') != NULL;
+		if (!has_extension && path_size + sizeof(extension) <= EV_CAPTURE_PATH_SIZE) memcpy(stream->path + path_size, extension, sizeof(extension));
+
+		EV_FOPEN(stream->raw_file, stream->path, "wb");
+		if (stream->raw_file) {
+			uint32_t header[4] = { 0x50414345, 1, (uint32_t)image_format, 0 };
+			fwrite(header, sizeof(header), 1, stream->raw_file);
+		}
+	}
+	else {
+		const char* extension = strrchr(path, '.');
+		size_t path_size = extension ? (size_t)(extension - path) : strlen(path);
+		memcpy(stream->path, path, path_size);
+		stream->path[path_size] = 0;
+
+		size_t raw_size = png_row_bytes(max_extent.width, max_extent.height);
+		stream->rows = EV_ALLOC(uint8_t, raw_size);
+		if (format == EV_CAPTURE_PNG) stream->encoded = EV_ALLOC(uint8_t, png_zlib_bytes(raw_size));
+	}
+
+	stream->writer = std::thread(capture_writer_main, stream);
+	return stream;
+}
+
+void destroy_capture_stream(Capture_Stream* stream) {
+	flush_capture(stream);
+	{
+		std::lock_guard<std::mutex> lock(stream->mutex);
+		stream->quit = true;
+	}
+	stream->work_cv.notify_all();
+	stream->writer.join();
+
+	if (stream->raw_file) fclose(stream->raw_file);
+	destroy_readback_ring(stream->gpu_if, &stream->ring);
+	EV_FREE(stream->slots);
+	EV_FREE(stream->pending);
+	EV_FREE(stream->rows);
+	EV_FREE(stream->encoded);
+	delete stream;
+}
+
+void resize_capture_stream(Capture_Stream* stream, VkExtent2D max_extent) {
+	flush_capture(stream);
+	std::lock_guard<std::mutex> lock(stream->mutex);
+	uint32_t slot_count = stream->ring.slot_count;
+	destroy_readback_ring(stream->gpu_if, &stream->ring);
+	stream->ring = create_readback_ring(stream->gpu_if, (VkDeviceSize)max_extent.width * max_extent.height * 4, slot_count);
+	if (stream->format != EV_CAPTURE_RAW) {
+		size_t raw_size = png_row_bytes(max_extent.width, max_extent.height);
+		stream->rows = EV_REALLOC(uint8_t, stream->rows, raw_size);
+		if (stream->format == EV_CAPTURE_PNG) stream->encoded = EV_REALLOC(uint8_t, stream->encoded, png_zlib_bytes(raw_size));
+	}
+}
+
+static uint32_t hand_off_completed(Capture_Stream* stream) {
+	uint32_t handed = 0;
+	uint32_t slot_count = stream->ring.slot_count;
+	for (uint32_t x = 0; x < slot_count; x++) {
+		uint32_t slot_ix = (stream->next_slot + x) % slot_count;
+		Capture_Slot* slot = &stream->slots[slot_ix];
+		if (slot->state != EV_CAPTURE_SLOT_GPU) continue;
+
+		const void* pixels = fetch_readback(stream->gpu_if, &stream->ring, slot_ix);
+		if (!pixels) continue;
+		slot->pixels = (const uint8_t*)pixels;
+		slot->state = EV_CAPTURE_SLOT_WRITING;
+		stream->submitted--;
+		stream->pending[(stream->pending_head + stream->pending_count++) % slot_count] = slot_ix;
+		handed++;
+	}
+	return handed;
+}
+
+uint32_t poll_capture(Capture_Stream* stream) {
+	uint32_t handed;
+	{
+		std::lock_guard<std::mutex> lock(stream->mutex);
+		handed = hand_off_completed(stream);
+	}
+	if (handed) stream->work_cv.notify_one();
+	return handed;
+}
+
+uint32_t begin_capture(Capture_Stream* stream, uint64_t frame) {
+	poll_capture(stream);
+
+	uint32_t slot_ix = stream->next_slot;
+	Capture_Slot* slot = &stream->slots[slot_ix];
+	std::unique_lock<std::mutex> lock(stream->mutex);
+	if (slot->state != EV_CAPTURE_SLOT_FREE) {
+		if (stream->policy == EV_CAPTURE_DROP) {
+			stream->dropped++;
+			return EV_CAPTURE_NONE;
+		}
+		if (slot->state == EV_CAPTURE_SLOT_GPU && stream->ring.values[slot_ix]) {
+			lock.unlock();
+			timeline_wait(stream->gpu_if, stream->ring.timeline, stream->ring.values[slot_ix]);
+			poll_capture(stream);
+			lock.lock();
+		}
+		stream->free_cv.wait(lock, [&] { return slot->state == EV_CAPTURE_SLOT_FREE; });
+	}
+
+	slot->state = EV_CAPTURE_SLOT_GPU;
+	slot->frame = frame;
+	slot->extent = {};
+	stream->next_slot = (slot_ix + 1) % stream->ring.slot_count;
+	return slot_ix;
+}
+
+void record_capture(Capture_Stream* stream, uint32_t slot, VkCommandBuffer cmd_buffer, VkImage image, VkExtent2D extent) {
+	if ((VkDeviceSize)extent.width * extent.height * 4 > stream->ring.slot_size) return;
+	stream->slots[slot].extent = extent;
+	record_image_readback(&stream->ring, slot, cmd_buffer, image, extent);
+}
+
+void submit_capture(Capture_Stream* stream, uint32_t slot, Timeline* timeline, uint64_t value) {
+	std::lock_guard<std::mutex> lock(stream->mutex);
+	if (stream->slots[slot].extent.width == 0) {
+		stream->slots[slot].state = EV_CAPTURE_SLOT_FREE;
+		stream->dropped++;
+		return;
+	}
+	submit_readback(&stream->ring, slot, timeline, value);
+	stream->submitted++;
+	stream->captured++;
+	stream->work_cv.notify_one();
+}
+
+void flush_capture(Capture_Stream* stream) {
+	uint64_t last_value = 0;
+	{
+		std::lock_guard<std::mutex> lock(stream->mutex);
+		for (uint32_t x = 0; x < stream->ring.slot_count; x++) {
+			if (stream->slots[x].state != EV_CAPTURE_SLOT_GPU) continue;
+			if (stream->ring.values[x] > last_value) last_value = stream->ring.values[x];
+			else if (stream->ring.values[x] == 0) stream->slots[x].state = EV_CAPTURE_SLOT_FREE;
+		}
+	}
+	if (last_value) timeline_wait(stream->gpu_if, stream->ring.timeline, last_value);
+	poll_capture(stream);
+
+	std::unique_lock<std::mutex> lock(stream->mutex);
+	stream->free_cv.wait(lock, [&] {
+		for (uint32_t x = 0; x < stream->ring.slot_count; x++) {
+			if (stream->slots[x].state == EV_CAPTURE_SLOT_WRITING) return false;
+		}
+		return true;
+	});
+}
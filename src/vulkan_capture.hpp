@@ -0,0 +1,83 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_readback.hpp"
+#include "vulkan_timeline.hpp"
+
+#define EV_CAPTURE_PATH_SIZE 260
+#define EV_CAPTURE_NONE UINT32_MAX
+
+enum Capture_Format
+{
+	EV_CAPTURE_PPM,
+	EV_CAPTURE_PNG,
+	EV_CAPTURE_RAW,
+};
+
+enum Capture_Policy
+{
+	EV_CAPTURE_DROP,
+	EV_CAPTURE_QUEUE,
+};
+
+enum Capture_Slot_State
+{
+	EV_CAPTURE_SLOT_FREE,
+	EV_CAPTURE_SLOT_GPU,
+	EV_CAPTURE_SLOT_WRITING,
+};
+
+struct Capture_Slot
+{
+	Capture_Slot_State state;
+	uint64_t frame;
+	VkExtent2D extent;
+	const uint8_t* pixels;
+};
+
+struct Capture_Stream
+{
+	GpuIF gpu_if;
+	Readback_Ring ring;
+	Capture_Slot* slots;
+	uint32_t* pending;
+	uint32_t pending_head;
+	uint32_t pending_count;
+	uint32_t submitted;
+	uint32_t next_slot;
+
+	Capture_Format format;
+	Capture_Policy policy;
+	bool swizzle;
+	char path[EV_CAPTURE_PATH_SIZE];
+	FILE* raw_file;
+	uint8_t* rows;
+	uint8_t* encoded;
+
+	uint64_t captured;
+	uint64_t written;
+	uint64_t dropped;
+	uint64_t failed;
+
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable free_cv;
+	std::thread writer;
+	bool quit;
+};
+
+Capture_Format capture_format_from_path(const char* path);
+Capture_Stream* create_capture_stream(GpuIF gpu_if, const char* path, Capture_Format format, Capture_Policy policy, VkFormat image_format, VkExtent2D max_extent,
+	uint32_t slot_count);
+void destroy_capture_stream(Capture_Stream* stream);
+void resize_capture_stream(Capture_Stream* stream, VkExtent2D max_extent);
+uint32_t begin_capture(Capture_Stream* stream, uint64_t frame);
+void record_capture(Capture_Stream* stream, uint32_t slot, VkCommandBuffer cmd_buffer, VkImage image, VkExtent2D extent);
+void submit_capture(Capture_Stream* stream, uint32_t slot, Timeline* timeline, uint64_t value);
+uint32_t poll_capture(Capture_Stream* stream);
+void flush_capture(Capture_Stream* stream);
@@ -0,0 +1,213 @@
+#include "vulkan_compute.hpp"
+
+static bool is_image_binding(VkDescriptorType type) {
+	return type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+}
+
+Compute_Kernel create_compute_kernel(GpuIF gpu_if, Pipeline_Cache* cache, Compute_Desc desc) {
+	EV_CHECK(desc.binding_count <= EV_COMPUTE_MAX_BINDINGS && desc.push_constant_size <= EV_COMPUTE_MAX_PUSH_CONSTANTS);
+	Compute_Kernel kernel = {};
+	kernel.desc = desc;
+
+	VkDescriptorSetLayoutBinding bindings[EV_COMPUTE_MAX_BINDINGS];
+	for (uint32_t x = 0; x < desc.binding_count; x++) {
+		bindings[x] = {};
+		bindings[x].binding = x;
+		bindings[x].descriptorType = desc.bindings[x].type;
+		bindings[x].descriptorCount = 1;
+		bindings[x].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo set_layout_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	set_layout_create_info.bindingCount = desc.binding_count;
+	set_layout_create_info.pBindings = bindings;
+	EV_CHECK_VKRESULT(vkCreateDescriptorSetLayout(gpu_if.device, &set_layout_create_info, NULL, &kernel.set_layout));
+
+	VkPushConstantRange push_range = { VK_SHADER_STAGE_COMPUTE_BIT, 0, desc.push_constant_size };
+	kernel.layout = create_pipeline_layout(gpu_if, &kernel.set_layout, 1, &push_range, desc.push_constant_size ? 1 : 0);
+	kernel.pipeline = create_compute_pipeline(gpu_if, cache, kernel.layout, desc.shader_file);
+	return kernel;
+}
+
+void destroy_compute_kernel(GpuIF gpu_if, Compute_Kernel* kernel) {
+	vkDestroyPipeline(gpu_if.device, kernel->pipeline, NULL);
+	vkDestroyPipelineLayout(gpu_if.device, kernel->layout, NULL);
+	vkDestroyDescriptorSetLayout(gpu_if.device, kernel->set_layout, NULL);
+}
+
+Compute_Batch create_compute_batch(Descriptor_Allocator* descriptors, Frame_Arena* scratch) {
+	Compute_Batch batch = {};
+	batch.descriptors = descriptors;
+	batch.scratch = scratch;
+	return batch;
+}
+
+void destroy_compute_batch(Compute_Batch* batch) {
+	EV_FREE(batch->accesses);
+}
+
+void begin_compute_batch(Compute_Batch* batch, VkCommandBuffer cmd_buffer, bool reference_mode) {
+	batch->cmd_buffer = cmd_buffer;
+	batch->access_count = 0;
+	batch->dispatch_count = 0;
+	batch->barrier_count = 0;
+	batch->reference_mode = reference_mode;
+}
+
+static VkDeviceSize access_end(Compute_Access* access) {
+	return access->range == VK_WHOLE_SIZE ? UINT64_MAX : access->offset + access->range;
+}
+
+static bool accesses_overlap(Compute_Access* a, Compute_Access* b) {
+	if (a->image || b->image) return a->image == b->image;
+	return a->buffer == b->buffer && a->offset < access_end(b) && b->offset < access_end(a);
+}
+
+static void flush_accesses(Compute_Batch* batch, bool needs_memory_barrier) {
+	VkBufferMemoryBarrier* buffer_barriers = EV_ARENA_ALLOC(batch->scratch, VkBufferMemoryBarrier, batch->access_count);
+	VkImageMemoryBarrier* image_barriers = EV_ARENA_ALLOC(batch->scratch, VkImageMemoryBarrier, batch->access_count);
+	uint32_t buffer_barrier_count = 0;
+	uint32_t image_barrier_count = 0;
+
+	for (uint32_t x = 0; x < batch->access_count && needs_memory_barrier; x++) {
+		Compute_Access* access = &batch->accesses[x];
+		if (!access->writes) continue;
+
+		if (access->image) {
+			VkImageMemoryBarrier* barrier = &image_barriers[image_barrier_count++];
+			*barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier->srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier->dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier->oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			barrier->newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->image = access->image;
+			barrier->subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+		}
+		else {
+			VkBufferMemoryBarrier* barrier = &buffer_barriers[buffer_barrier_count++];
+			*barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+			barrier->srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier->dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier->buffer = access->buffer;
+			barrier->offset = access->offset;
+			barrier->size = access->range;
+		}
+	}
+
+	vkCmdPipelineBarrier(batch->cmd_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, NULL, buffer_barrier_count, buffer_barriers, image_barrier_count, image_barriers);
+	batch->barrier_count++;
+
+	uint32_t kept = 0;
+	for (uint32_t x = 0; x < batch->access_count && !needs_memory_barrier; x++) {
+		if (batch->accesses[x].writes) batch->accesses[kept++] = batch->accesses[x];
+	}
+	batch->access_count = kept;
+}
+
+static void track_access(Compute_Batch* batch, Compute_Access access) {
+	for (uint32_t x = 0; x < batch->access_count; x++) {
+		Compute_Access* tracked = &batch->accesses[x];
+		if (tracked->buffer == access.buffer && tracked->image == access.image && tracked->offset == access.offset && tracked->range == access.range) {
+			tracked->writes |= access.writes;
+			return;
+		}
+	}
+	if (batch->access_count == batch->access_capacity) {
+		batch->access_capacity = batch->access_capacity ? batch->access_capacity * 2 : 16;
+		batch->accesses = EV_REALLOC(Compute_Access, batch->accesses, batch->access_capacity);
+	}
+	batch->accesses[batch->access_count++] = access;
+}
+
+static Compute_Access make_access(Compute_Binding binding, const Compute_Resource* resource) {
+	Compute_Access access = {};
+	access.writes = binding.writes;
+	if (is_image_binding(binding.type)) {
+		access.image = resource->image;
+	}
+	else {
+		access.buffer = resource->buffer->buffer;
+		access.offset = resource->offset;
+		access.range = resource->range;
+	}
+	return access;
+}
+
+void run_compute_reference(Compute_Kernel* kernel, void** buffers, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z) {
+	EV_CHECK(kernel->desc.reference);
+	kernel->desc.reference(buffers, push_constants, group_x, group_y, group_z);
+}
+
+void record_dispatch(GpuIF gpu_if, Compute_Batch* batch, Compute_Kernel* kernel, const Compute_Resource* resources, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z) {
+	Compute_Desc* desc = &kernel->desc;
+	batch->dispatch_count++;
+
+	if (batch->reference_mode) {
+		void* buffers[EV_COMPUTE_MAX_BINDINGS];
+		for (uint32_t x = 0; x < desc->binding_count; x++) {
+			EV_CHECK(!is_image_binding(desc->bindings[x].type) && resources[x].buffer->allocation.mapped);
+			buffers[x] = resources[x].buffer->allocation.mapped + resources[x].offset;
+		}
+		run_compute_reference(kernel, buffers, push_constants, group_x, group_y, group_z);
+		return;
+	}
+
+	bool has_hazard = false;
+	bool has_write_hazard = false;
+	for (uint32_t x = 0; x < desc->binding_count; x++) {
+		Compute_Access access = make_access(desc->bindings[x], &resources[x]);
+		for (uint32_t y = 0; y < batch->access_count; y++) {
+			Compute_Access* tracked = &batch->accesses[y];
+			if (!accesses_overlap(tracked, &access) || !(tracked->writes || access.writes)) continue;
+			has_hazard = true;
+			has_write_hazard |= tracked->writes;
+		}
+	}
+	if (has_hazard) flush_accesses(batch, has_write_hazard);
+
+	VkDescriptorSet set = allocate_descriptor_set(gpu_if, batch->descriptors, kernel->set_layout);
+
+	VkWriteDescriptorSet writes[EV_COMPUTE_MAX_BINDINGS];
+	VkDescriptorBufferInfo buffer_infos[EV_COMPUTE_MAX_BINDINGS];
+	VkDescriptorImageInfo image_infos[EV_COMPUTE_MAX_BINDINGS];
+	for (uint32_t x = 0; x < desc->binding_count; x++) {
+		writes[x] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+		writes[x].dstSet = set;
+		writes[x].dstBinding = x;
+		writes[x].descriptorCount = 1;
+		writes[x].descriptorType = desc->bindings[x].type;
+		if (is_image_binding(desc->bindings[x].type)) {
+			VkImageLayout layout = resources[x].sampler ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+			image_infos[x] = { resources[x].sampler, resources[x].view, layout };
+			writes[x].pImageInfo = &image_infos[x];
+		}
+		else {
+			buffer_infos[x] = { resources[x].buffer->buffer, resources[x].offset, resources[x].range };
+			writes[x].pBufferInfo = &buffer_infos[x];
+		}
+		track_access(batch, make_access(desc->bindings[x], &resources[x]));
+	}
+	vkUpdateDescriptorSets(gpu_if.device, desc->binding_count, writes, 0, NULL);
+
+	vkCmdBindPipeline(batch->cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipeline);
+	vkCmdBindDescriptorSets(batch->cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->layout, 0, 1, &set, 0, NULL);
+	if (desc->push_constant_size) {
+		vkCmdPushConstants(batch->cmd_buffer, kernel->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, desc->push_constant_size, push_constants);
+	}
+	vkCmdDispatch(batch->cmd_buffer, group_x, group_y, group_z);
+}
+
+void end_compute_batch(Compute_Batch* batch, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access) {
+	if (batch->reference_mode || batch->dispatch_count == 0) return;
+
+	VkMemoryBarrier memory_barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memory_barrier.dstAccessMask = dst_access;
+	vkCmdPipelineBarrier(batch->cmd_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dst_stages, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+	batch->access_count = 0;
+}
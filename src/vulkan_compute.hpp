@@ -0,0 +1,78 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_pipeline.hpp"
+#include "vulkan_descriptor.hpp"
+#include "vulkan_arena.hpp"
+
+#define EV_COMPUTE_MAX_BINDINGS 8
+#define EV_COMPUTE_MAX_PUSH_CONSTANTS 128
+
+typedef void Compute_Reference(void** buffers, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z);
+
+struct Compute_Binding
+{
+	VkDescriptorType type;
+	bool writes;
+};
+
+struct Compute_Desc
+{
+	const char* shader_file;
+	Compute_Binding bindings[EV_COMPUTE_MAX_BINDINGS];
+	uint32_t binding_count;
+	uint32_t push_constant_size;
+	Compute_Reference* reference;
+};
+
+struct Compute_Kernel
+{
+	VkDescriptorSetLayout set_layout;
+	VkPipelineLayout layout;
+	VkPipeline pipeline;
+	Compute_Desc desc;
+};
+
+struct Compute_Resource
+{
+	BufferBlock* buffer;
+	VkDeviceSize offset;
+	VkDeviceSize range;
+	VkImage image;
+	VkImageView view;
+	VkSampler sampler;
+};
+
+struct Compute_Access
+{
+	VkBuffer buffer;
+	VkImage image;
+	VkDeviceSize offset;
+	VkDeviceSize range;
+	bool writes;
+};
+
+struct Compute_Batch
+{
+	Descriptor_Allocator* descriptors;
+	Frame_Arena* scratch;
+	VkCommandBuffer cmd_buffer;
+	Compute_Access* accesses;
+	uint32_t access_count;
+	uint32_t access_capacity;
+	uint32_t dispatch_count;
+	uint32_t barrier_count;
+	bool reference_mode;
+};
+
+Compute_Kernel create_compute_kernel(GpuIF gpu_if, Pipeline_Cache* cache, Compute_Desc desc);
+void destroy_compute_kernel(GpuIF gpu_if, Compute_Kernel* kernel);
+Compute_Batch create_compute_batch(Descriptor_Allocator* descriptors, Frame_Arena* scratch);
+void destroy_compute_batch(Compute_Batch* batch);
+void begin_compute_batch(Compute_Batch* batch, VkCommandBuffer cmd_buffer, bool reference_mode);
+void record_dispatch(GpuIF gpu_if, Compute_Batch* batch, Compute_Kernel* kernel, const Compute_Resource* resources, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z);
+void end_compute_batch(Compute_Batch* batch, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access);
+void run_compute_reference(Compute_Kernel* kernel, void** buffers, const void* push_constants, uint32_t group_x, uint32_t group_y, uint32_t group_z);
@@ -1,5 +1,9 @@
+#include <string.h>
 #include "vulkan_context.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_deletion.hpp"
 
+#ifdef VK_USE_PLATFORM_WIN32_KHR
 HWND create_win32_window(WND_PROC window_proc, uint32_t width, uint32_t height) {
 	HINSTANCE instance = GetModuleHandle(NULL);
 	WNDCLASS wc{};
@@ -16,8 +20,9 @@ HWND create_win32_window(WND_PROC window_proc, uint32_t width, uint32_t height)
 	ShowWindow(window, SW_NORMAL);
 	return window;
 }
+#endif
 
-void vulkan_context_init(VK_CTX* ctx, HWND window) {
+static void create_instance(VK_CTX* ctx, const char** instance_exts, uint32_t ext_count) {
 	VkApplicationInfo app_info = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
 	app_info.apiVersion = VK_API_VERSION_1_2;
 
@@ -30,62 +35,221 @@ void vulkan_context_init(VK_CTX* ctx, HWND window) {
 	instance_create_info.ppEnabledLayerNames = layers;
 #endif
 
-	instance_create_info.enabledExtensionCount = 2;
-	const char* instance_exts[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME };
+	instance_create_info.enabledExtensionCount = ext_count;
 	instance_create_info.ppEnabledExtensionNames = instance_exts;
 
+	load_vulkan_loader();
 	EV_CHECK_VKRESULT(vkCreateInstance(&instance_create_info, NULL, &ctx->instance));
+	load_vulkan_instance(ctx->instance);
 
-	uint32_t gpu_count;
-	vkEnumeratePhysicalDevices(ctx->instance, &gpu_count, NULL);
+	uint32_t gpu_count = 1;
 	vkEnumeratePhysicalDevices(ctx->instance, &gpu_count, &ctx->gpu_if.gpu);
+	EV_CHECK(gpu_count > 0);
+}
+
+static bool has_device_extension(VkExtensionProperties* properties, uint32_t count, const char* name) {
+	for (uint32_t x = 0; x < count; x++) {
+		if (strcmp(properties[x].extensionName, name) == 0) return true;
+	}
+	return false;
+}
+
+static void select_device_features(VK_CTX* ctx, VkPhysicalDeviceFeatures2* enabled, VkPhysicalDeviceVulkan12Features* enabled_12) {
+	VkPhysicalDeviceVulkan12Features supported_12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	VkPhysicalDeviceFeatures2 supported = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	supported.pNext = &supported_12;
+	vkGetPhysicalDeviceFeatures2(ctx->gpu_if.gpu, &supported);
+
+	*enabled_12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	*enabled = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	enabled->pNext = enabled_12;
+
+	EV_CHECK(supported_12.timelineSemaphore);
+	enabled_12->timelineSemaphore = VK_TRUE;
+	EV_CHECK(supported.features.drawIndirectFirstInstance);
+	enabled->features.drawIndirectFirstInstance = VK_TRUE;
+
+	if (supported_12.descriptorIndexing && supported_12.runtimeDescriptorArray &&
+		supported_12.descriptorBindingPartiallyBound && supported_12.descriptorBindingUpdateUnusedWhilePending &&
+		supported_12.descriptorBindingStorageBufferUpdateAfterBind && supported_12.descriptorBindingSampledImageUpdateAfterBind &&
+		supported_12.shaderSampledImageArrayNonUniformIndexing && supported_12.shaderStorageBufferArrayNonUniformIndexing) {
+		enabled_12->descriptorIndexing = VK_TRUE;
+		enabled_12->runtimeDescriptorArray = VK_TRUE;
+		enabled_12->descriptorBindingPartiallyBound = VK_TRUE;
+		enabled_12->descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		enabled_12->descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		enabled_12->descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		enabled_12->shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		enabled_12->shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+		ctx->gpu_if.features |= EV_FEATURE_DESCRIPTOR_INDEXING;
+	}
+	if (supported.features.multiDrawIndirect) {
+		enabled->features.multiDrawIndirect = VK_TRUE;
+		ctx->gpu_if.features |= EV_FEATURE_MULTI_DRAW_INDIRECT;
+	}
+	if (supported.features.textureCompressionBC) {
+		enabled->features.textureCompressionBC = VK_TRUE;
+		ctx->gpu_if.features |= EV_FEATURE_TEXTURE_COMPRESSION_BC;
+	}
+	if (supported_12.drawIndirectCount) {
+		enabled_12->drawIndirectCount = VK_TRUE;
+		ctx->gpu_if.features |= EV_FEATURE_DRAW_INDIRECT_COUNT;
+	}
+}
+
+static uint32_t find_queue_family(VkQueueFamilyProperties* families, uint32_t family_count, VkQueueFlags required, VkQueueFlags excluded) {
+	for (uint32_t x = 0; x < family_count; x++) {
+		if ((families[x].queueFlags & required) == required && !(families[x].queueFlags & excluded)) return x;
+	}
+	return UINT32_MAX;
+}
+
+static void select_queue_families(VK_CTX* ctx) {
+	uint32_t family_count;
+	vkGetPhysicalDeviceQueueFamilyProperties(ctx->gpu_if.gpu, &family_count, NULL);
+	VkQueueFamilyProperties* families = EV_ALLOC(VkQueueFamilyProperties, family_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(ctx->gpu_if.gpu, &family_count, families);
+
+	uint32_t graphics = UINT32_MAX;
+	for (uint32_t x = 0; x < family_count && graphics == UINT32_MAX; x++) {
+		if (!(families[x].queueFlags & VK_QUEUE_GRAPHICS_BIT)) continue;
+		VkBool32 present_supported = VK_TRUE;
+		if (ctx->surface) vkGetPhysicalDeviceSurfaceSupportKHR(ctx->gpu_if.gpu, x, ctx->surface, &present_supported);
+		if (present_supported) graphics = x;
+	}
+	EV_CHECK(graphics != UINT32_MAX);
+
+	uint32_t compute = find_queue_family(families, family_count, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+	if (compute == UINT32_MAX) compute = graphics;
+
+	uint32_t transfer = find_queue_family(families, family_count, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+	if (transfer == UINT32_MAX) transfer = find_queue_family(families, family_count, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT);
+	if (transfer == UINT32_MAX) transfer = compute;
+	EV_FREE(families);
+
+	ctx->gpu_if.queues[EV_QUEUE_GRAPHICS] = { VK_NULL_HANDLE, graphics };
+	ctx->gpu_if.queues[EV_QUEUE_COMPUTE] = { VK_NULL_HANDLE, compute };
+	ctx->gpu_if.queues[EV_QUEUE_TRANSFER] = { VK_NULL_HANDLE, transfer };
+}
+
+static void create_device(VK_CTX* ctx, const char** required_exts, uint32_t required_count) {
+	uint32_t property_count;
+	vkEnumerateDeviceExtensionProperties(ctx->gpu_if.gpu, NULL, &property_count, NULL);
+	VkExtensionProperties* properties = EV_ALLOC(VkExtensionProperties, property_count);
+	vkEnumerateDeviceExtensionProperties(ctx->gpu_if.gpu, NULL, &property_count, properties);
+
+	const char** device_exts = EV_ALLOC(const char*, required_count + 2);
+	uint32_t ext_count = 0;
+	for (uint32_t x = 0; x < required_count; x++) {
+		device_exts[ext_count++] = required_exts[x];
+	}
+
+	ctx->gpu_if.features = 0;
+	if (has_device_extension(properties, property_count, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME)) {
+		device_exts[ext_count++] = VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+		ctx->gpu_if.features |= EV_FEATURE_PIPELINE_CREATION_FEEDBACK;
+	}
+	if (has_device_extension(properties, property_count, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+		device_exts[ext_count++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+		ctx->gpu_if.features |= EV_FEATURE_MEMORY_BUDGET;
+	}
+	EV_FREE(properties);
 
+	select_queue_families(ctx);
 	float priority = 1.0F;
-	VkDeviceQueueCreateInfo queue_create_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
-	queue_create_info.queueCount = 1;
-	queue_create_info.pQueuePriorities = &priority;
-	queue_create_info.queueFamilyIndex = 0;
+	VkDeviceQueueCreateInfo queue_create_infos[EV_QUEUE_KIND_COUNT];
+	uint32_t queue_create_count = 0;
+	for (uint32_t x = 0; x < EV_QUEUE_KIND_COUNT; x++) {
+		uint32_t family = ctx->gpu_if.queues[x].family;
+		bool is_duplicate = false;
+		for (uint32_t y = 0; y < queue_create_count; y++) {
+			is_duplicate |= queue_create_infos[y].queueFamilyIndex == family;
+		}
+		if (is_duplicate) continue;
+
+		VkDeviceQueueCreateInfo* queue_create_info = &queue_create_infos[queue_create_count++];
+		*queue_create_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+		queue_create_info->queueCount = 1;
+		queue_create_info->pQueuePriorities = &priority;
+		queue_create_info->queueFamilyIndex = family;
+	}
+
+	VkPhysicalDeviceFeatures2 features;
+	VkPhysicalDeviceVulkan12Features features_12;
+	select_device_features(ctx, &features, &features_12);
 
-	VkPhysicalDeviceFeatures features = {};
 	VkDeviceCreateInfo device_create_info = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
-	device_create_info.pEnabledFeatures = &features;
-	device_create_info.queueCreateInfoCount = 1;
-	device_create_info.pQueueCreateInfos = &queue_create_info;
+	device_create_info.pNext = &features;
+	device_create_info.queueCreateInfoCount = queue_create_count;
+	device_create_info.pQueueCreateInfos = queue_create_infos;
 
-	device_create_info.enabledExtensionCount = 1;
-	const char* device_exts[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	device_create_info.enabledExtensionCount = ext_count;
 	device_create_info.ppEnabledExtensionNames = device_exts;
 
 	EV_CHECK_VKRESULT(vkCreateDevice(ctx->gpu_if.gpu, &device_create_info, NULL, &ctx->gpu_if.device));
+	load_vulkan_device(ctx->gpu_if.device);
+	EV_FREE(device_exts);
 
-	VkWin32SurfaceCreateInfoKHR surface_create_info{ VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR };
-	surface_create_info.hwnd = window;
-	surface_create_info.hinstance = GetModuleHandle(NULL);
+	for (uint32_t x = 0; x < EV_QUEUE_KIND_COUNT; x++) {
+		vkGetDeviceQueue(ctx->gpu_if.device, ctx->gpu_if.queues[x].family, 0, &ctx->gpu_if.queues[x].queue);
+	}
+	ctx->gpu_if.allocator = EV_ALLOC(Device_Allocator, 1);
+	create_device_allocator(ctx->gpu_if, ctx->gpu_if.allocator);
+}
 
-	EV_CHECK_VKRESULT(vkCreateWin32SurfaceKHR(ctx->instance, &surface_create_info, NULL, &ctx->surface));
+static void create_image_views(GpuIF gpu_if, Present_Structure* present) {
+	VkImageViewCreateInfo view_create_info = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	view_create_info.format = present->format.format;
+	view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	view_create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	view_create_info.subresourceRange.levelCount = 1;
+	view_create_info.subresourceRange.layerCount = 1;
+
+	for (uint32_t x = 0; x < present->image_count; x++) {
+		view_create_info.image = present->images[x];
+		EV_CHECK_VKRESULT(vkCreateImageView(gpu_if.device, &view_create_info, NULL, &present->views[x]));
+	}
+}
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+static VkPresentModeKHR select_present_mode(VK_CTX* ctx, VkPresentModeKHR requested) {
+	uint32_t mode_count;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(ctx->gpu_if.gpu, ctx->surface, &mode_count, NULL);
+	VkPresentModeKHR* modes = EV_ALLOC(VkPresentModeKHR, mode_count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(ctx->gpu_if.gpu, ctx->surface, &mode_count, modes);
 
-	VkBool32 present_supported;
-	vkGetPhysicalDeviceSurfaceSupportKHR(ctx->gpu_if.gpu, 0, ctx->surface, &present_supported);
+	VkPresentModeKHR selected = VK_PRESENT_MODE_FIFO_KHR;
+	for (uint32_t x = 0; x < mode_count; x++) {
+		if (modes[x] == requested) selected = requested;
+	}
+	EV_FREE(modes);
+	return selected;
+}
 
+static bool create_swapchain(VK_CTX* ctx, VkSwapchainKHR old_swapchain) {
 	VkSurfaceCapabilitiesKHR caps;
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(ctx->gpu_if.gpu, ctx->surface, &caps);
+	EV_CHECK_VKRESULT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(ctx->gpu_if.gpu, ctx->surface, &caps));
+	if (caps.currentExtent.width == 0 || caps.currentExtent.height == 0) return false;
 	ctx->present.extent = caps.currentExtent;
 
-	ctx->present.format = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	uint32_t min_image_count = caps.minImageCount + 1;
+	if (caps.maxImageCount && min_image_count > caps.maxImageCount) min_image_count = caps.maxImageCount;
+	ctx->present.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (caps.supportedUsageFlags & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
 
 	VkSwapchainCreateInfoKHR swapchain_create_info = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
     swapchain_create_info.surface = ctx->surface;
-    swapchain_create_info.minImageCount = 2;
+    swapchain_create_info.minImageCount = min_image_count;
     swapchain_create_info.imageFormat = ctx->present.format.format;
     swapchain_create_info.imageColorSpace = ctx->present.format.colorSpace;
     swapchain_create_info.imageExtent = caps.currentExtent;
     swapchain_create_info.imageArrayLayers = 1;
-    swapchain_create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    swapchain_create_info.imageUsage = ctx->present.usage;
     swapchain_create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchain_create_info.preTransform = caps.currentTransform;
     swapchain_create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    swapchain_create_info.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    swapchain_create_info.presentMode = ctx->present.present_mode;
     swapchain_create_info.clipped = VK_TRUE;
+    swapchain_create_info.oldSwapchain = old_swapchain;
 
 	EV_CHECK_VKRESULT(vkCreateSwapchainKHR(ctx->gpu_if.device, &swapchain_create_info, NULL, &ctx->present.swapchain));
 
@@ -94,17 +258,71 @@ void vulkan_context_init(VK_CTX* ctx, HWND window) {
 	ctx->present.views = EV_ALLOC(VkImageView, ctx->present.image_count);
 	vkGetSwapchainImagesKHR(ctx->gpu_if.device, ctx->present.swapchain, &ctx->present.image_count, ctx->present.images);
 
-	VkImageViewCreateInfo view_create_info = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-	view_create_info.format = ctx->present.format.format;
-	view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	view_create_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	view_create_info.subresourceRange.levelCount = 1;
-	view_create_info.subresourceRange.layerCount = 1;
+	create_image_views(ctx->gpu_if, &ctx->present);
+	return true;
+}
 
-	for (uint32_t x = 0; x < ctx->present.image_count; x++) {
-		view_create_info.image = ctx->present.images[x];
-		EV_CHECK_VKRESULT(vkCreateImageView(ctx->gpu_if.device, &view_create_info, NULL, &ctx->present.views[x]));
+void vulkan_context_init(VK_CTX* ctx, HWND window, VkPresentModeKHR present_mode) {
+	const char* instance_exts[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME };
+	create_instance(ctx, instance_exts, 2);
+
+	VkWin32SurfaceCreateInfoKHR surface_create_info{ VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR };
+	surface_create_info.hwnd = window;
+	surface_create_info.hinstance = GetModuleHandle(NULL);
+
+	EV_CHECK_VKRESULT(vkCreateWin32SurfaceKHR(ctx->instance, &surface_create_info, NULL, &ctx->surface));
+
+	const char* device_exts[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	create_device(ctx, device_exts, 1);
+	ctx->headless = false;
+
+	ctx->present.format = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	ctx->present.present_mode = select_present_mode(ctx, present_mode);
+	EV_CHECK(create_swapchain(ctx, VK_NULL_HANDLE));
+}
+
+bool recreate_swapchain(VK_CTX* ctx, VkRenderPass renderpass, Deletion_Queue* deletions) {
+	Present_Structure old_present = ctx->present;
+	if (!create_swapchain(ctx, old_present.swapchain)) return false;
+
+	for (uint32_t x = 0; x < old_present.image_count; x++) {
+		defer_destroy_framebuffer(deletions, old_present.framebuffers[x]);
+		defer_destroy_image_view(deletions, old_present.views[x]);
 	}
+	defer_destroy_swapchain(deletions, old_present.swapchain);
+	EV_FREE(old_present.framebuffers);
+	EV_FREE(old_present.views);
+	EV_FREE(old_present.images);
+
+	create_framebuffers(ctx->gpu_if, renderpass, &ctx->present);
+	return true;
+}
+#endif
+
+void vulkan_context_init_headless(VK_CTX* ctx, VkExtent2D extent, uint32_t image_count) {
+	create_instance(ctx, NULL, 0);
+	ctx->surface = VK_NULL_HANDLE;
+	create_device(ctx, NULL, 0);
+	ctx->headless = true;
+
+	ctx->present.swapchain = VK_NULL_HANDLE;
+	ctx->present.extent = extent;
+	ctx->present.format = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	ctx->present.present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+	ctx->present.image_count = image_count;
+	ctx->present.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	ctx->present.images = EV_ALLOC(VkImage, image_count);
+	ctx->present.views = EV_ALLOC(VkImageView, image_count);
+
+	ctx->present.allocations = EV_ALLOC(Memory_Allocation, image_count);
+	for (uint32_t x = 0; x < image_count; x++) {
+		ImageBlock block = create_imageblock(ctx->gpu_if, { extent.width, extent.height, 1 }, ctx->present.usage);
+		bind_imageblock(ctx->gpu_if, &block, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		ctx->present.images[x] = block.image;
+		ctx->present.allocations[x] = block.allocation;
+	}
+
+	create_image_views(ctx->gpu_if, &ctx->present);
 }
 
 void create_framebuffers(GpuIF gpu_if, VkRenderPass renderpass, Present_Structure* present) {
@@ -131,17 +349,29 @@ void vulkan_context_terminate(VK_CTX* ctx) {
 	}
 	EV_FREE(ctx->present.framebuffers);
 	EV_FREE(ctx->present.views);
+	if (ctx->headless) {
+		for (uint32_t x = 0; x < ctx->present.image_count; x++) {
+			vkDestroyImage(ctx->gpu_if.device, ctx->present.images[x], NULL);
+			free_device_memory(ctx->gpu_if, ctx->present.allocations[x]);
+		}
+		EV_FREE(ctx->present.allocations);
+	}
+	else {
+		vkDestroySwapchainKHR(ctx->gpu_if.device, ctx->present.swapchain, NULL);
+		vkDestroySurfaceKHR(ctx->instance, ctx->surface, NULL);
+	}
 	EV_FREE(ctx->present.images);
-	vkDestroySwapchainKHR(ctx->gpu_if.device, ctx->present.swapchain, NULL);
-	vkDestroySurfaceKHR(ctx->instance, ctx->surface, NULL);
+	destroy_device_allocator(ctx->gpu_if, ctx->gpu_if.allocator);
+	EV_FREE(ctx->gpu_if.allocator);
 	vkDestroyDevice(ctx->gpu_if.device, NULL);
 	vkDestroyInstance(ctx->instance, NULL);
+	unload_vulkan_loader();
 }
 
-VkCommandPool create_command_pool(GpuIF gpu_if) {
+VkCommandPool create_command_pool(GpuIF gpu_if, uint32_t queue_family, VkCommandPoolCreateFlags flags) {
 	VkCommandPoolCreateInfo cmd_pool_create_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
-	cmd_pool_create_info.queueFamilyIndex = 0;
-	cmd_pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	cmd_pool_create_info.queueFamilyIndex = queue_family;
+	cmd_pool_create_info.flags = flags;
 
 	VkCommandPool cmd_pool;
 	EV_CHECK_VKRESULT(vkCreateCommandPool(gpu_if.device, &cmd_pool_create_info, NULL, &cmd_pool));
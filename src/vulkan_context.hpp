@@ -1,16 +1,22 @@
 #pragma once
 
 #undef UNICODE
-#include <vulkan/vulkan.h>
+#include "vulkan_dispatch.hpp"
 #include "utils.hpp"
 #include "vulkan_structs.hpp"
 
+struct Deletion_Queue;
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
 typedef LRESULT CALLBACK WND_PROC(HWND, UINT, WPARAM, LPARAM);
 HWND create_win32_window(WND_PROC window_proc, uint32_t width, uint32_t height);
-void vulkan_context_init(VK_CTX* ctx, HWND window);
+void vulkan_context_init(VK_CTX* ctx, HWND window, VkPresentModeKHR present_mode);
+bool recreate_swapchain(VK_CTX* ctx, VkRenderPass renderpass, Deletion_Queue* deletions);
+#endif
+void vulkan_context_init_headless(VK_CTX* ctx, VkExtent2D extent, uint32_t image_count);
 void vulkan_context_terminate(VK_CTX* ctx);
 void create_framebuffers(GpuIF gpu_if, VkRenderPass renderpass, Present_Structure* present);
-VkCommandPool create_command_pool(GpuIF gpu_if);
+VkCommandPool create_command_pool(GpuIF gpu_if, uint32_t queue_family, VkCommandPoolCreateFlags flags);
 VkCommandBuffer* allocate_command_buffers(GpuIF gpu_if, VkCommandPool pool, uint32_t count);
 VkSemaphore create_semaphore(GpuIF gpu_if);
 VkFence* create_fences(GpuIF gpu_if, uint32_t count);
@@ -0,0 +1,80 @@
+#include <math.h>
+#include <string.h>
+#include "vulkan_cull.hpp"
+
+Cull_Context create_cull_context(GpuIF gpu_if, Pipeline_Cache* cache, Mesh_Pool* pool, Upload_Context* upload) {
+	EV_CHECK(pool->mesh_count > 0);
+	Compute_Desc desc = {};
+	desc.shader_file = "shaders/cull.comp.spv";
+	desc.bindings[0] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, false };
+	desc.bindings[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, false };
+	desc.bindings[2] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, false };
+	desc.bindings[3] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, true };
+	desc.bindings[4] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, true };
+	desc.binding_count = 5;
+
+	Cull_Context cull = {};
+	cull.frustum_kernel = create_compute_kernel(gpu_if, cache, desc);
+
+	VkDeviceSize table_size = sizeof(Mesh) * pool->mesh_count;
+	cull.mesh_table = create_bufferblock(gpu_if, table_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	bind_bufferblock(gpu_if, &cull.mesh_table, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	upload_buffer(gpu_if, upload, cull.mesh_table, 0, pool->meshes, table_size);
+	return cull;
+}
+
+void destroy_cull_context(GpuIF gpu_if, Cull_Context* cull) {
+	destroy_compute_kernel(gpu_if, &cull->frustum_kernel);
+	destroy_bufferblock(gpu_if, cull->mesh_table);
+}
+
+void extract_frustum_planes(const float* m, float planes[6][4]) {
+	for (uint32_t x = 0; x < 4; x++) {
+		float row0 = m[x * 4 + 0];
+		float row1 = m[x * 4 + 1];
+		float row2 = m[x * 4 + 2];
+		float row3 = m[x * 4 + 3];
+		planes[0][x] = row3 + row0;
+		planes[1][x] = row3 - row0;
+		planes[2][x] = row3 + row1;
+		planes[3][x] = row3 - row1;
+		planes[4][x] = row2;
+		planes[5][x] = row3 - row2;
+	}
+	for (uint32_t x = 0; x < 6; x++) {
+		float length = sqrtf(planes[x][0] * planes[x][0] + planes[x][1] * planes[x][1] + planes[x][2] * planes[x][2]);
+		for (uint32_t y = 0; y < 4; y++) planes[x][y] /= length;
+	}
+}
+
+void record_cull(GpuIF gpu_if, Cull_Context* cull, Compute_Batch* batch, Gpu_Arena* constants, const float* view_proj,
+	BufferBlock* instances, uint32_t instance_count, Draw_List* list) {
+	EV_CHECK(instance_count <= list->capacity);
+
+	Arena_Slice view_slice = gpu_arena_push(constants, sizeof(Cull_View));
+	Cull_View* view = (Cull_View*)view_slice.mapped;
+	memcpy(view->view_proj, view_proj, sizeof(view->view_proj));
+	extract_frustum_planes(view_proj, view->planes);
+	view->instance_count = instance_count;
+
+	bool use_draw_count = gpu_if.features & EV_FEATURE_DRAW_INDIRECT_COUNT;
+	VkCommandBuffer cmd_buffer = batch->cmd_buffer;
+	VkMemoryBarrier memory_barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 0, NULL);
+	vkCmdFillBuffer(cmd_buffer, list->count.buffer, 0, sizeof(uint32_t), 0);
+	if (!use_draw_count) vkCmdFillBuffer(cmd_buffer, list->commands.buffer, 0, VK_WHOLE_SIZE, 0);
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+
+	Compute_Resource resources[5] = {};
+	resources[0] = { view_slice.block, view_slice.offset, sizeof(Cull_View) };
+	resources[1] = { instances, 0, sizeof(Cull_Instance) * instance_count };
+	resources[2] = { &cull->mesh_table, 0, VK_WHOLE_SIZE };
+	resources[3] = { &list->commands, 0, VK_WHOLE_SIZE };
+	resources[4] = { &list->count, 0, VK_WHOLE_SIZE };
+
+	uint32_t group_count = (instance_count + EV_CULL_GROUP_SIZE - 1) / EV_CULL_GROUP_SIZE;
+	record_dispatch(gpu_if, batch, &cull->frustum_kernel, resources, NULL, group_count, 1, 1);
+	list->draw_count = instance_count;
+}
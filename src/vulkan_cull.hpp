@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_compute.hpp"
+#include "vulkan_mesh.hpp"
+#include "vulkan_arena.hpp"
+
+#define EV_CULL_GROUP_SIZE 64
+
+struct Cull_Instance
+{
+	float center[3];
+	float radius;
+	uint32_t mesh_ix;
+	uint32_t pad[3];
+};
+
+struct Cull_View
+{
+	float view_proj[16];
+	float planes[6][4];
+	uint32_t instance_count;
+	uint32_t pad[3];
+};
+
+struct Cull_Context
+{
+	Compute_Kernel frustum_kernel;
+	BufferBlock mesh_table;
+};
+
+Cull_Context create_cull_context(GpuIF gpu_if, Pipeline_Cache* cache, Mesh_Pool* pool, Upload_Context* upload);
+void destroy_cull_context(GpuIF gpu_if, Cull_Context* cull);
+void extract_frustum_planes(const float* view_proj, float planes[6][4]);
+void record_cull(GpuIF gpu_if, Cull_Context* cull, Compute_Batch* batch, Gpu_Arena* constants, const float* view_proj,
+	BufferBlock* instances, uint32_t instance_count, Draw_List* list);
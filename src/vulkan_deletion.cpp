@@ -0,0 +1,96 @@
+#include "vulkan_deletion.hpp"
+
+Deletion_Queue create_deletion_queue(Timeline* timeline) {
+	Deletion_Queue queue = {};
+	queue.timeline = timeline;
+	return queue;
+}
+
+static void destroy_entry(GpuIF gpu_if, Deletion_Entry* entry) {
+	switch (entry->kind) {
+	case EV_DELETE_BUFFER: destroy_bufferblock(gpu_if, entry->buffer); break;
+	case EV_DELETE_IMAGE: destroy_imageblock(gpu_if, entry->image); break;
+	case EV_DELETE_IMAGE_VIEW: vkDestroyImageView(gpu_if.device, entry->view, NULL); break;
+	case EV_DELETE_FRAMEBUFFER: vkDestroyFramebuffer(gpu_if.device, entry->framebuffer, NULL); break;
+	case EV_DELETE_SAMPLER: vkDestroySampler(gpu_if.device, entry->sampler, NULL); break;
+	case EV_DELETE_PIPELINE: vkDestroyPipeline(gpu_if.device, entry->pipeline, NULL); break;
+	case EV_DELETE_SWAPCHAIN: vkDestroySwapchainKHR(gpu_if.device, entry->swapchain, NULL); break;
+	}
+}
+
+void destroy_deletion_queue(GpuIF gpu_if, Deletion_Queue* queue) {
+	for (uint32_t x = 0; x < queue->count; x++) {
+		Deletion_Entry* entry = &queue->entries[x];
+		uint64_t submitted = entry->timeline->value;
+		timeline_wait(gpu_if, entry->timeline, entry->value < submitted ? entry->value : submitted);
+		destroy_entry(gpu_if, entry);
+	}
+	queue->destroyed += queue->count;
+	EV_FREE(queue->entries);
+}
+
+void defer_deletion(Deletion_Queue* queue, Deletion_Entry entry) {
+	if (queue->count == queue->capacity) {
+		queue->capacity = queue->capacity ? queue->capacity * 2 : 64;
+		queue->entries = EV_REALLOC(Deletion_Entry, queue->entries, queue->capacity);
+	}
+	queue->entries[queue->count++] = entry;
+}
+
+static Deletion_Entry* push_entry(Deletion_Queue* queue, Deletion_Kind kind) {
+	Deletion_Entry entry = {};
+	entry.kind = kind;
+	entry.timeline = queue->timeline;
+	entry.value = queue->timeline->value + 1;
+	defer_deletion(queue, entry);
+	return &queue->entries[queue->count - 1];
+}
+
+void defer_destroy_buffer(Deletion_Queue* queue, BufferBlock block) {
+	push_entry(queue, EV_DELETE_BUFFER)->buffer = block;
+}
+
+void defer_destroy_image(Deletion_Queue* queue, ImageBlock block) {
+	push_entry(queue, EV_DELETE_IMAGE)->image = block;
+}
+
+void defer_destroy_image_view(Deletion_Queue* queue, VkImageView view) {
+	push_entry(queue, EV_DELETE_IMAGE_VIEW)->view = view;
+}
+
+void defer_destroy_framebuffer(Deletion_Queue* queue, VkFramebuffer framebuffer) {
+	push_entry(queue, EV_DELETE_FRAMEBUFFER)->framebuffer = framebuffer;
+}
+
+void defer_destroy_sampler(Deletion_Queue* queue, VkSampler sampler) {
+	push_entry(queue, EV_DELETE_SAMPLER)->sampler = sampler;
+}
+
+void defer_destroy_pipeline(Deletion_Queue* queue, VkPipeline pipeline) {
+	push_entry(queue, EV_DELETE_PIPELINE)->pipeline = pipeline;
+}
+
+void defer_destroy_swapchain(Deletion_Queue* queue, VkSwapchainKHR swapchain) {
+	push_entry(queue, EV_DELETE_SWAPCHAIN)->swapchain = swapchain;
+}
+
+uint32_t flush_deletions(GpuIF gpu_if, Deletion_Queue* queue) {
+	if (queue->count == 0) return 0;
+	Timeline* timeline = NULL;
+	uint64_t completed = 0;
+
+	uint32_t kept = 0;
+	for (uint32_t x = 0; x < queue->count; x++) {
+		Deletion_Entry* entry = &queue->entries[x];
+		if (entry->timeline != timeline) {
+			timeline = entry->timeline;
+			completed = timeline_completed(gpu_if, timeline);
+		}
+		if (entry->value > completed) queue->entries[kept++] = *entry;
+		else destroy_entry(gpu_if, entry);
+	}
+	uint32_t flushed = queue->count - kept;
+	queue->count = kept;
+	queue->destroyed += flushed;
+	return flushed;
+}
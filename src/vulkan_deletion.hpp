@@ -0,0 +1,56 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_timeline.hpp"
+
+enum Deletion_Kind
+{
+	EV_DELETE_BUFFER,
+	EV_DELETE_IMAGE,
+	EV_DELETE_IMAGE_VIEW,
+	EV_DELETE_FRAMEBUFFER,
+	EV_DELETE_SAMPLER,
+	EV_DELETE_PIPELINE,
+	EV_DELETE_SWAPCHAIN,
+};
+
+struct Deletion_Entry
+{
+	Deletion_Kind kind;
+	Timeline* timeline;
+	uint64_t value;
+	union
+	{
+		BufferBlock buffer;
+		ImageBlock image;
+		VkImageView view;
+		VkFramebuffer framebuffer;
+		VkSampler sampler;
+		VkPipeline pipeline;
+		VkSwapchainKHR swapchain;
+	};
+};
+
+struct Deletion_Queue
+{
+	Timeline* timeline;
+	Deletion_Entry* entries;
+	uint32_t count;
+	uint32_t capacity;
+	uint64_t destroyed;
+};
+
+Deletion_Queue create_deletion_queue(Timeline* timeline);
+void destroy_deletion_queue(GpuIF gpu_if, Deletion_Queue* queue);
+void defer_deletion(Deletion_Queue* queue, Deletion_Entry entry);
+void defer_destroy_buffer(Deletion_Queue* queue, BufferBlock block);
+void defer_destroy_image(Deletion_Queue* queue, ImageBlock block);
+void defer_destroy_image_view(Deletion_Queue* queue, VkImageView view);
+void defer_destroy_framebuffer(Deletion_Queue* queue, VkFramebuffer framebuffer);
+void defer_destroy_sampler(Deletion_Queue* queue, VkSampler sampler);
+void defer_destroy_pipeline(Deletion_Queue* queue, VkPipeline pipeline);
+void defer_destroy_swapchain(Deletion_Queue* queue, VkSwapchainKHR swapchain);
+uint32_t flush_deletions(GpuIF gpu_if, Deletion_Queue* queue);
@@ -0,0 +1,221 @@
+#include <string.h>
+#include "vulkan_descriptor.hpp"
+
+static VkDescriptorPool create_transient_pool(GpuIF gpu_if, uint32_t max_sets) {
+	VkDescriptorPoolSize pool_sizes[] = {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_sets * 4 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, max_sets * 2 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, max_sets },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, max_sets * 4 },
+		{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, max_sets },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, max_sets },
+	};
+	VkDescriptorPoolCreateInfo pool_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	pool_create_info.maxSets = max_sets;
+	pool_create_info.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]);
+	pool_create_info.pPoolSizes = pool_sizes;
+
+	VkDescriptorPool pool;
+	EV_CHECK_VKRESULT(vkCreateDescriptorPool(gpu_if.device, &pool_create_info, NULL, &pool));
+	return pool;
+}
+
+Descriptor_Allocator create_descriptor_allocator(GpuIF gpu_if, uint32_t frame_count, uint32_t sets_per_pool) {
+	EV_CHECK(frame_count > 0 && frame_count <= EV_MAX_FRAMES_IN_FLIGHT);
+	Descriptor_Allocator allocator = {};
+	allocator.frame_count = frame_count;
+	allocator.sets_per_pool = sets_per_pool;
+
+	for (uint32_t x = 0; x < frame_count; x++) {
+		allocator.frames[x].pools = EV_ALLOC(VkDescriptorPool, 1);
+		allocator.frames[x].pools[0] = create_transient_pool(gpu_if, sets_per_pool);
+		allocator.frames[x].pool_count = 1;
+	}
+	return allocator;
+}
+
+void destroy_descriptor_allocator(GpuIF gpu_if, Descriptor_Allocator* allocator) {
+	for (uint32_t x = 0; x < allocator->frame_count; x++) {
+		Descriptor_Pool_List* list = &allocator->frames[x];
+		for (uint32_t y = 0; y < list->pool_count; y++) {
+			vkDestroyDescriptorPool(gpu_if.device, list->pools[y], NULL);
+		}
+		EV_FREE(list->pools);
+	}
+}
+
+void reset_descriptor_frame(GpuIF gpu_if, Descriptor_Allocator* allocator, uint32_t frame_ix) {
+	Descriptor_Pool_List* list = &allocator->frames[frame_ix];
+	for (uint32_t x = 0; x <= list->current && x < list->pool_count; x++) {
+		EV_CHECK_VKRESULT(vkResetDescriptorPool(gpu_if.device, list->pools[x], 0));
+	}
+	list->current = 0;
+	allocator->frame_ix = frame_ix;
+}
+
+VkDescriptorSet allocate_descriptor_set(GpuIF gpu_if, Descriptor_Allocator* allocator, VkDescriptorSetLayout layout) {
+	Descriptor_Pool_List* list = &allocator->frames[allocator->frame_ix];
+
+	VkDescriptorSetAllocateInfo set_allocate_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	set_allocate_info.descriptorSetCount = 1;
+	set_allocate_info.pSetLayouts = &layout;
+
+	for (;;) {
+		set_allocate_info.descriptorPool = list->pools[list->current];
+		VkDescriptorSet set;
+		VkResult result = vkAllocateDescriptorSets(gpu_if.device, &set_allocate_info, &set);
+		if (result == VK_SUCCESS) return set;
+		EV_CHECK(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL);
+
+		list->current++;
+		if (list->current == list->pool_count) {
+			list->pools = EV_REALLOC(VkDescriptorPool, list->pools, list->pool_count + 1);
+			list->pools[list->pool_count++] = create_transient_pool(gpu_if, allocator->sets_per_pool);
+		}
+	}
+}
+
+static Bindless_Slots create_bindless_slots(uint32_t capacity) {
+	Bindless_Slots slots = {};
+	slots.free_slots = EV_ALLOC(uint32_t, capacity);
+	slots.retired_slots = EV_ALLOC(uint32_t, capacity);
+	slots.retired_values = EV_ALLOC(uint64_t, capacity);
+	slots.capacity = capacity;
+	return slots;
+}
+
+static void destroy_bindless_slots(Bindless_Slots* slots) {
+	EV_FREE(slots->free_slots);
+	EV_FREE(slots->retired_slots);
+	EV_FREE(slots->retired_values);
+}
+
+static void reclaim_bindless_slots(GpuIF gpu_if, Bindless_Slots* slots, Timeline* timeline) {
+	if (slots->retired_count == 0) return;
+	uint64_t completed = timeline_completed(gpu_if, timeline);
+	uint32_t reclaimed = 0;
+	while (reclaimed < slots->retired_count && slots->retired_values[reclaimed] <= completed) {
+		slots->free_slots[slots->free_count++] = slots->retired_slots[reclaimed++];
+	}
+	slots->retired_count -= reclaimed;
+	memmove(slots->retired_slots, slots->retired_slots + reclaimed, sizeof(uint32_t) * slots->retired_count);
+	memmove(slots->retired_values, slots->retired_values + reclaimed, sizeof(uint64_t) * slots->retired_count);
+}
+
+static uint32_t acquire_bindless_slot(GpuIF gpu_if, Bindless_Slots* slots, Timeline* timeline) {
+	if (slots->free_count == 0) reclaim_bindless_slots(gpu_if, slots, timeline);
+	if (slots->free_count) return slots->free_slots[--slots->free_count];
+	if (slots->used == slots->capacity && slots->retired_count) {
+		timeline_wait(gpu_if, timeline, slots->retired_values[0]);
+		reclaim_bindless_slots(gpu_if, slots, timeline);
+		return slots->free_slots[--slots->free_count];
+	}
+	EV_CHECK(slots->used < slots->capacity);
+	return slots->used++;
+}
+
+static void retire_bindless_slot(Bindless_Slots* slots, Timeline* timeline, uint32_t handle) {
+	EV_CHECK(handle < slots->used && slots->retired_count < slots->capacity);
+	slots->retired_slots[slots->retired_count] = handle;
+	slots->retired_values[slots->retired_count++] = timeline->value + 1;
+}
+
+Bindless_Table create_bindless_table(GpuIF gpu_if, Timeline* timeline, uint32_t buffer_capacity, uint32_t texture_capacity) {
+	EV_CHECK(gpu_if.features & EV_FEATURE_DESCRIPTOR_INDEXING);
+	Bindless_Table table = {};
+	table.timeline = timeline;
+	table.buffers = create_bindless_slots(buffer_capacity);
+	table.textures = create_bindless_slots(texture_capacity);
+
+	VkDescriptorSetLayoutBinding bindings[2] = {};
+	bindings[EV_BINDLESS_BUFFER_BINDING].binding = EV_BINDLESS_BUFFER_BINDING;
+	bindings[EV_BINDLESS_BUFFER_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[EV_BINDLESS_BUFFER_BINDING].descriptorCount = buffer_capacity;
+	bindings[EV_BINDLESS_BUFFER_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+	bindings[EV_BINDLESS_TEXTURE_BINDING].binding = EV_BINDLESS_TEXTURE_BINDING;
+	bindings[EV_BINDLESS_TEXTURE_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[EV_BINDLESS_TEXTURE_BINDING].descriptorCount = texture_capacity;
+	bindings[EV_BINDLESS_TEXTURE_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+	VkDescriptorBindingFlags binding_flags[2];
+	binding_flags[0] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+	binding_flags[1] = binding_flags[0];
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+	binding_flags_info.bindingCount = 2;
+	binding_flags_info.pBindingFlags = binding_flags;
+
+	VkDescriptorSetLayoutCreateInfo set_layout_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	set_layout_create_info.pNext = &binding_flags_info;
+	set_layout_create_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	set_layout_create_info.bindingCount = 2;
+	set_layout_create_info.pBindings = bindings;
+	EV_CHECK_VKRESULT(vkCreateDescriptorSetLayout(gpu_if.device, &set_layout_create_info, NULL, &table.layout));
+
+	VkDescriptorPoolSize pool_sizes[] = {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffer_capacity },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, texture_capacity },
+	};
+	VkDescriptorPoolCreateInfo pool_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	pool_create_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	pool_create_info.maxSets = 1;
+	pool_create_info.poolSizeCount = 2;
+	pool_create_info.pPoolSizes = pool_sizes;
+	EV_CHECK_VKRESULT(vkCreateDescriptorPool(gpu_if.device, &pool_create_info, NULL, &table.pool));
+
+	VkDescriptorSetAllocateInfo set_allocate_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	set_allocate_info.descriptorPool = table.pool;
+	set_allocate_info.descriptorSetCount = 1;
+	set_allocate_info.pSetLayouts = &table.layout;
+	EV_CHECK_VKRESULT(vkAllocateDescriptorSets(gpu_if.device, &set_allocate_info, &table.set));
+	return table;
+}
+
+void destroy_bindless_table(GpuIF gpu_if, Bindless_Table* table) {
+	vkDestroyDescriptorPool(gpu_if.device, table->pool, NULL);
+	vkDestroyDescriptorSetLayout(gpu_if.device, table->layout, NULL);
+	destroy_bindless_slots(&table->buffers);
+	destroy_bindless_slots(&table->textures);
+}
+
+uint32_t bindless_add_buffer(GpuIF gpu_if, Bindless_Table* table, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+	uint32_t handle = acquire_bindless_slot(gpu_if, &table->buffers, table->timeline);
+
+	VkDescriptorBufferInfo buffer_info = { buffer, offset, range };
+	VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+	write.dstSet = table->set;
+	write.dstBinding = EV_BINDLESS_BUFFER_BINDING;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &buffer_info;
+	vkUpdateDescriptorSets(gpu_if.device, 1, &write, 0, NULL);
+	return handle;
+}
+
+uint32_t bindless_add_texture(GpuIF gpu_if, Bindless_Table* table, VkImageView view, VkSampler sampler, VkImageLayout layout) {
+	uint32_t handle = acquire_bindless_slot(gpu_if, &table->textures, table->timeline);
+
+	VkDescriptorImageInfo image_info = { sampler, view, layout };
+	VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+	write.dstSet = table->set;
+	write.dstBinding = EV_BINDLESS_TEXTURE_BINDING;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &image_info;
+	vkUpdateDescriptorSets(gpu_if.device, 1, &write, 0, NULL);
+	return handle;
+}
+
+void bindless_remove_buffer(Bindless_Table* table, uint32_t handle) {
+	retire_bindless_slot(&table->buffers, table->timeline, handle);
+}
+
+void bindless_remove_texture(Bindless_Table* table, uint32_t handle) {
+	retire_bindless_slot(&table->textures, table->timeline, handle);
+}
+
+void bind_bindless_table(Bindless_Table* table, VkCommandBuffer cmd_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set_index) {
+	vkCmdBindDescriptorSets(cmd_buffer, bind_point, layout, set_index, 1, &table->set, 0, NULL);
+}
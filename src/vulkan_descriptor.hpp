@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_frame.hpp"
+#include "vulkan_timeline.hpp"
+
+#define EV_BINDLESS_BUFFER_BINDING 0
+#define EV_BINDLESS_TEXTURE_BINDING 1
+#define EV_BINDLESS_INVALID UINT32_MAX
+
+struct Descriptor_Pool_List
+{
+	VkDescriptorPool* pools;
+	uint32_t pool_count;
+	uint32_t current;
+};
+
+struct Descriptor_Allocator
+{
+	Descriptor_Pool_List frames[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t frame_count;
+	uint32_t frame_ix;
+	uint32_t sets_per_pool;
+};
+
+struct Bindless_Slots
+{
+	uint32_t* free_slots;
+	uint32_t free_count;
+	uint32_t* retired_slots;
+	uint64_t* retired_values;
+	uint32_t retired_count;
+	uint32_t used;
+	uint32_t capacity;
+};
+
+struct Bindless_Table
+{
+	VkDescriptorSetLayout layout;
+	VkDescriptorPool pool;
+	VkDescriptorSet set;
+	Timeline* timeline;
+	Bindless_Slots buffers;
+	Bindless_Slots textures;
+};
+
+Descriptor_Allocator create_descriptor_allocator(GpuIF gpu_if, uint32_t frame_count, uint32_t sets_per_pool);
+void destroy_descriptor_allocator(GpuIF gpu_if, Descriptor_Allocator* allocator);
+void reset_descriptor_frame(GpuIF gpu_if, Descriptor_Allocator* allocator, uint32_t frame_ix);
+VkDescriptorSet allocate_descriptor_set(GpuIF gpu_if, Descriptor_Allocator* allocator, VkDescriptorSetLayout layout);
+
+Bindless_Table create_bindless_table(GpuIF gpu_if, Timeline* timeline, uint32_t buffer_capacity, uint32_t texture_capacity);
+void destroy_bindless_table(GpuIF gpu_if, Bindless_Table* table);
+uint32_t bindless_add_buffer(GpuIF gpu_if, Bindless_Table* table, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+uint32_t bindless_add_texture(GpuIF gpu_if, Bindless_Table* table, VkImageView view, VkSampler sampler, VkImageLayout layout);
+void bindless_remove_buffer(Bindless_Table* table, uint32_t handle);
+void bindless_remove_texture(Bindless_Table* table, uint32_t handle);
+void bind_bindless_table(Bindless_Table* table, VkCommandBuffer cmd_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set_index);
@@ -0,0 +1,72 @@
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+
+#ifndef EV_VULKAN_STATIC
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define EV_DEFINE_VULKAN_FUNCTION(name) PFN_##name name;
+EV_DEFINE_VULKAN_FUNCTION(vkGetInstanceProcAddr)
+EV_VULKAN_GLOBAL_FUNCTIONS(EV_DEFINE_VULKAN_FUNCTION)
+EV_VULKAN_INSTANCE_FUNCTIONS(EV_DEFINE_VULKAN_FUNCTION)
+EV_VULKAN_PLATFORM_FUNCTIONS(EV_DEFINE_VULKAN_FUNCTION)
+EV_VULKAN_DEVICE_FUNCTIONS(EV_DEFINE_VULKAN_FUNCTION)
+#undef EV_DEFINE_VULKAN_FUNCTION
+
+static void* loader_library;
+#endif
+
+void load_vulkan_loader() {
+#ifndef EV_VULKAN_STATIC
+	if (loader_library) return;
+#ifdef _WIN32
+	HMODULE library = LoadLibraryA("vulkan-1.dll");
+	EV_CHECK(library);
+	vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)(void(*)(void))GetProcAddress(library, "vkGetInstanceProcAddr");
+	loader_library = (void*)library;
+#else
+	void* library = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (!library) library = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+	EV_CHECK(library);
+	vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)dlsym(library, "vkGetInstanceProcAddr");
+	loader_library = library;
+#endif
+	EV_CHECK(vkGetInstanceProcAddr);
+
+#define EV_LOAD_GLOBAL_FUNCTION(name) name = (PFN_##name)vkGetInstanceProcAddr(VK_NULL_HANDLE, #name);
+	EV_VULKAN_GLOBAL_FUNCTIONS(EV_LOAD_GLOBAL_FUNCTION)
+#undef EV_LOAD_GLOBAL_FUNCTION
+#endif
+}
+
+void load_vulkan_instance(VkInstance instance) {
+#ifndef EV_VULKAN_STATIC
+#define EV_LOAD_INSTANCE_FUNCTION(name) name = (PFN_##name)vkGetInstanceProcAddr(instance, #name);
+	EV_VULKAN_INSTANCE_FUNCTIONS(EV_LOAD_INSTANCE_FUNCTION)
+	EV_VULKAN_PLATFORM_FUNCTIONS(EV_LOAD_INSTANCE_FUNCTION)
+#undef EV_LOAD_INSTANCE_FUNCTION
+#endif
+}
+
+void load_vulkan_device(VkDevice device) {
+#ifndef EV_VULKAN_STATIC
+#define EV_LOAD_DEVICE_FUNCTION(name) name = (PFN_##name)vkGetDeviceProcAddr(device, #name);
+	EV_VULKAN_DEVICE_FUNCTIONS(EV_LOAD_DEVICE_FUNCTION)
+#undef EV_LOAD_DEVICE_FUNCTION
+#endif
+}
+
+void unload_vulkan_loader() {
+#ifndef EV_VULKAN_STATIC
+	if (!loader_library) return;
+#ifdef _WIN32
+	FreeLibrary((HMODULE)loader_library);
+#else
+	dlclose(loader_library);
+#endif
+	loader_library = NULL;
+#endif
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef EV_VULKAN_STATIC
+#ifndef VK_NO_PROTOTYPES
+#define VK_NO_PROTOTYPES
+#endif
+#endif
+#include <vulkan/vulkan.h>
+
+#define EV_VULKAN_GLOBAL_FUNCTIONS(X)\
+	X(vkCreateInstance)\
+	X(vkEnumerateInstanceExtensionProperties)
+
+#define EV_VULKAN_INSTANCE_FUNCTIONS(X)\
+	X(vkDestroyInstance)\
+	X(vkEnumeratePhysicalDevices)\
+	X(vkGetPhysicalDeviceProperties)\
+	X(vkGetPhysicalDeviceFeatures2)\
+	X(vkGetPhysicalDeviceMemoryProperties)\
+	X(vkGetPhysicalDeviceMemoryProperties2)\
+	X(vkGetPhysicalDeviceQueueFamilyProperties)\
+	X(vkGetPhysicalDeviceFormatProperties)\
+	X(vkEnumerateDeviceExtensionProperties)\
+	X(vkCreateDevice)\
+	X(vkGetDeviceProcAddr)\
+	X(vkDestroySurfaceKHR)\
+	X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR)\
+	X(vkGetPhysicalDeviceSurfacePresentModesKHR)\
+	X(vkGetPhysicalDeviceSurfaceSupportKHR)
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+#define EV_VULKAN_PLATFORM_FUNCTIONS(X)\
+	X(vkCreateWin32SurfaceKHR)
+#else
+#define EV_VULKAN_PLATFORM_FUNCTIONS(X)
+#endif
+
+#define EV_VULKAN_DEVICE_FUNCTIONS(X)\
+	X(vkDestroyDevice)\
+	X(vkGetDeviceQueue)\
+	X(vkDeviceWaitIdle)\
+	X(vkQueueSubmit)\
+	X(vkQueuePresentKHR)\
+	X(vkAcquireNextImageKHR)\
+	X(vkCreateSwapchainKHR)\
+	X(vkDestroySwapchainKHR)\
+	X(vkGetSwapchainImagesKHR)\
+	X(vkCreateSemaphore)\
+	X(vkDestroySemaphore)\
+	X(vkGetSemaphoreCounterValue)\
+	X(vkWaitSemaphores)\
+	X(vkCreateFence)\
+	X(vkAllocateMemory)\
+	X(vkFreeMemory)\
+	X(vkMapMemory)\
+	X(vkFlushMappedMemoryRanges)\
+	X(vkInvalidateMappedMemoryRanges)\
+	X(vkCreateBuffer)\
+	X(vkDestroyBuffer)\
+	X(vkBindBufferMemory)\
+	X(vkGetBufferMemoryRequirements)\
+	X(vkCreateImage)\
+	X(vkDestroyImage)\
+	X(vkBindImageMemory)\
+	X(vkGetImageMemoryRequirements)\
+	X(vkCreateImageView)\
+	X(vkDestroyImageView)\
+	X(vkCreateSampler)\
+	X(vkDestroySampler)\
+	X(vkCreateFramebuffer)\
+	X(vkDestroyFramebuffer)\
+	X(vkCreateRenderPass)\
+	X(vkDestroyRenderPass)\
+	X(vkCreateShaderModule)\
+	X(vkDestroyShaderModule)\
+	X(vkCreatePipelineCache)\
+	X(vkDestroyPipelineCache)\
+	X(vkGetPipelineCacheData)\
+	X(vkCreatePipelineLayout)\
+	X(vkDestroyPipelineLayout)\
+	X(vkCreateGraphicsPipelines)\
+	X(vkCreateComputePipelines)\
+	X(vkDestroyPipeline)\
+	X(vkCreateDescriptorSetLayout)\
+	X(vkDestroyDescriptorSetLayout)\
+	X(vkCreateDescriptorPool)\
+	X(vkDestroyDescriptorPool)\
+	X(vkResetDescriptorPool)\
+	X(vkAllocateDescriptorSets)\
+	X(vkUpdateDescriptorSets)\
+	X(vkCreateQueryPool)\
+	X(vkDestroyQueryPool)\
+	X(vkGetQueryPoolResults)\
+	X(vkCreateCommandPool)\
+	X(vkDestroyCommandPool)\
+	X(vkResetCommandPool)\
+	X(vkAllocateCommandBuffers)\
+	X(vkBeginCommandBuffer)\
+	X(vkEndCommandBuffer)\
+	X(vkCmdBeginRenderPass)\
+	X(vkCmdEndRenderPass)\
+	X(vkCmdExecuteCommands)\
+	X(vkCmdBindPipeline)\
+	X(vkCmdBindDescriptorSets)\
+	X(vkCmdBindVertexBuffers)\
+	X(vkCmdBindIndexBuffer)\
+	X(vkCmdPushConstants)\
+	X(vkCmdSetViewport)\
+	X(vkCmdSetScissor)\
+	X(vkCmdDraw)\
+	X(vkCmdDrawIndexedIndirect)\
+	X(vkCmdDrawIndexedIndirectCount)\
+	X(vkCmdDispatch)\
+	X(vkCmdPipelineBarrier)\
+	X(vkCmdCopyBuffer)\
+	X(vkCmdCopyBufferToImage)\
+	X(vkCmdCopyImageToBuffer)\
+	X(vkCmdBlitImage)\
+	X(vkCmdFillBuffer)\
+	X(vkCmdResetQueryPool)\
+	X(vkCmdWriteTimestamp)
+
+#ifndef EV_VULKAN_STATIC
+#define EV_DECLARE_VULKAN_FUNCTION(name) extern PFN_##name name;
+EV_DECLARE_VULKAN_FUNCTION(vkGetInstanceProcAddr)
+EV_VULKAN_GLOBAL_FUNCTIONS(EV_DECLARE_VULKAN_FUNCTION)
+EV_VULKAN_INSTANCE_FUNCTIONS(EV_DECLARE_VULKAN_FUNCTION)
+EV_VULKAN_PLATFORM_FUNCTIONS(EV_DECLARE_VULKAN_FUNCTION)
+EV_VULKAN_DEVICE_FUNCTIONS(EV_DECLARE_VULKAN_FUNCTION)
+#undef EV_DECLARE_VULKAN_FUNCTION
+#endif
+
+void load_vulkan_loader();
+void load_vulkan_instance(VkInstance instance);
+void load_vulkan_device(VkDevice device);
+void unload_vulkan_loader();
@@ -0,0 +1,118 @@
+#include "vulkan_frame.hpp"
+#include "vulkan_context.hpp"
+#include "vulkan_queue.hpp"
+
+Frame_Scheduler create_frame_scheduler(GpuIF gpu_if, uint32_t frame_count, uint32_t image_count) {
+	EV_CHECK(frame_count > 0 && frame_count <= EV_MAX_FRAMES_IN_FLIGHT);
+
+	Frame_Scheduler scheduler = {};
+	scheduler.frame_count = frame_count;
+	scheduler.image_count = image_count;
+	scheduler.timeline = create_timeline(gpu_if);
+
+	for (uint32_t x = 0; x < frame_count; x++) {
+		scheduler.frames[x].image_acquired = create_semaphore(gpu_if);
+		scheduler.frames[x].submitted_value = 0;
+	}
+
+	scheduler.render_complete = EV_ALLOC(VkSemaphore, image_count);
+	scheduler.image_values = EV_ALLOC(uint64_t, image_count);
+	for (uint32_t x = 0; x < image_count; x++) {
+		scheduler.render_complete[x] = create_semaphore(gpu_if);
+		scheduler.image_values[x] = 0;
+	}
+	return scheduler;
+}
+
+void destroy_frame_scheduler(GpuIF gpu_if, Frame_Scheduler* scheduler) {
+	timeline_wait(gpu_if, &scheduler->timeline, scheduler->timeline.value);
+	for (uint32_t x = 0; x < scheduler->frame_count; x++) {
+		vkDestroySemaphore(gpu_if.device, scheduler->frames[x].image_acquired, NULL);
+	}
+	for (uint32_t x = 0; x < scheduler->image_count; x++) {
+		vkDestroySemaphore(gpu_if.device, scheduler->render_complete[x], NULL);
+	}
+	destroy_timeline(gpu_if, &scheduler->timeline);
+	EV_FREE(scheduler->render_complete);
+	EV_FREE(scheduler->image_values);
+}
+
+void resize_frame_images(GpuIF gpu_if, Frame_Scheduler* scheduler, uint32_t image_count) {
+	if (image_count <= scheduler->image_count) return;
+	scheduler->render_complete = EV_REALLOC(VkSemaphore, scheduler->render_complete, image_count);
+	scheduler->image_values = EV_REALLOC(uint64_t, scheduler->image_values, image_count);
+	for (uint32_t x = scheduler->image_count; x < image_count; x++) {
+		scheduler->render_complete[x] = create_semaphore(gpu_if);
+		scheduler->image_values[x] = 0;
+	}
+	scheduler->image_count = image_count;
+}
+
+bool begin_frame(GpuIF gpu_if, Frame_Scheduler* scheduler, Present_Structure* present) {
+	Frame_Sync* frame = &scheduler->frames[scheduler->frame_ix];
+	timeline_wait(gpu_if, &scheduler->timeline, frame->submitted_value);
+
+	if (present->swapchain) {
+		VkResult result = vkAcquireNextImageKHR(gpu_if.device, present->swapchain, UINT64_MAX, frame->image_acquired, VK_NULL_HANDLE, &scheduler->image_ix);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			scheduler->swapchain_dirty = true;
+			return false;
+		}
+		if (result == VK_SUBOPTIMAL_KHR) scheduler->swapchain_dirty = true;
+		else EV_CHECK_VKRESULT(result);
+	}
+	else {
+		scheduler->image_ix = scheduler->frame_number % scheduler->image_count;
+	}
+
+	timeline_wait(gpu_if, &scheduler->timeline, scheduler->image_values[scheduler->image_ix]);
+	return true;
+}
+
+uint64_t submit_frame(Frame_Scheduler* scheduler, Present_Structure* present, VkQueue queue, VkCommandBuffer* cmd_buffers, uint32_t cmd_buffer_count,
+	const Semaphore_Point* waits, uint32_t wait_count) {
+	EV_CHECK(wait_count <= EV_MAX_FRAME_WAITS);
+	Frame_Sync* frame = &scheduler->frames[scheduler->frame_ix];
+	uint64_t value = timeline_advance(&scheduler->timeline);
+
+	Semaphore_Point wait_points[EV_MAX_FRAME_WAITS + 1];
+	for (uint32_t x = 0; x < wait_count; x++) {
+		wait_points[x] = waits[x];
+	}
+	Semaphore_Point signal_points[2];
+	signal_points[0] = timeline_point(&scheduler->timeline, value, 0);
+
+	Queue_Submit submit = {};
+	submit.cmd_buffers = cmd_buffers;
+	submit.cmd_buffer_count = cmd_buffer_count;
+	submit.waits = wait_points;
+	submit.wait_count = wait_count;
+	submit.signals = signal_points;
+	submit.signal_count = 1;
+	if (present->swapchain) {
+		wait_points[submit.wait_count++] = { frame->image_acquired, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		signal_points[submit.signal_count++] = { scheduler->render_complete[scheduler->image_ix], 0, 0 };
+	}
+	submit_queue(queue, submit, VK_NULL_HANDLE);
+
+	frame->submitted_value = value;
+	scheduler->image_values[scheduler->image_ix] = value;
+	return value;
+}
+
+void present_frame(Frame_Scheduler* scheduler, Present_Structure* present, VkQueue queue) {
+	if (present->swapchain) {
+		VkPresentInfoKHR present_info = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+		present_info.swapchainCount = 1;
+		present_info.pSwapchains = &present->swapchain;
+		present_info.pImageIndices = &scheduler->image_ix;
+		present_info.waitSemaphoreCount = 1;
+		present_info.pWaitSemaphores = &scheduler->render_complete[scheduler->image_ix];
+		VkResult result = vkQueuePresentKHR(queue, &present_info);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) scheduler->swapchain_dirty = true;
+		else EV_CHECK_VKRESULT(result);
+	}
+
+	scheduler->frame_ix = (scheduler->frame_ix + 1) % scheduler->frame_count;
+	scheduler->frame_number++;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_timeline.hpp"
+
+#define EV_MAX_FRAMES_IN_FLIGHT 3
+#define EV_MAX_FRAME_WAITS 8
+
+struct Frame_Sync
+{
+	VkSemaphore image_acquired;
+	uint64_t submitted_value;
+};
+
+struct Frame_Scheduler
+{
+	Frame_Sync frames[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t frame_count;
+	uint32_t frame_ix;
+
+	Timeline timeline;
+	VkSemaphore* render_complete;
+	uint64_t* image_values;
+	uint32_t image_count;
+	uint32_t image_ix;
+	uint64_t frame_number;
+	bool swapchain_dirty;
+};
+
+Frame_Scheduler create_frame_scheduler(GpuIF gpu_if, uint32_t frame_count, uint32_t image_count);
+void destroy_frame_scheduler(GpuIF gpu_if, Frame_Scheduler* scheduler);
+void resize_frame_images(GpuIF gpu_if, Frame_Scheduler* scheduler, uint32_t image_count);
+bool begin_frame(GpuIF gpu_if, Frame_Scheduler* scheduler, Present_Structure* present);
+uint64_t submit_frame(Frame_Scheduler* scheduler, Present_Structure* present, VkQueue queue, VkCommandBuffer* cmd_buffers, uint32_t cmd_buffer_count,
+	const Semaphore_Point* waits, uint32_t wait_count);
+void present_frame(Frame_Scheduler* scheduler, Present_Structure* present, VkQueue queue);
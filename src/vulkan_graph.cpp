@@ -0,0 +1,571 @@
+#include <string.h>
+#include "vulkan_graph.hpp"
+#include "vulkan_resource.hpp"
+
+struct Graph_Access_Info
+{
+	VkPipelineStageFlags stages;
+	VkAccessFlags access;
+	VkImageLayout layout;
+	bool reads;
+	bool writes;
+};
+
+struct Graph_State
+{
+	VkImageLayout layout;
+	VkPipelineStageFlags write_stages;
+	VkAccessFlags write_access;
+	VkPipelineStageFlags read_stages;
+	VkPipelineStageFlags visible_stages;
+};
+
+static bool is_depth_format(VkFormat format) {
+	return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+static VkImageAspectFlags format_aspect(VkFormat format) {
+	if (format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT) return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	return is_depth_format(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+static Graph_Access_Info access_info(Graph_Use* use, Graph_Pass_Kind kind) {
+	VkPipelineStageFlags shader_stages = kind == EV_GRAPH_PASS_RASTER ? VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT :
+		kind == EV_GRAPH_PASS_COMPUTE ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+	bool loads = use->load_op == VK_ATTACHMENT_LOAD_OP_LOAD;
+
+	switch (use->access) {
+	case EV_GRAPH_COLOR_ATTACHMENT:
+		return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, loads, true };
+	case EV_GRAPH_DEPTH_ATTACHMENT:
+		return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, loads, true };
+	case EV_GRAPH_SAMPLED:
+		return { shader_stages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true, false };
+	case EV_GRAPH_STORAGE_READ:
+		return { shader_stages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, true, false };
+	case EV_GRAPH_STORAGE_WRITE:
+		return { shader_stages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true, true };
+	case EV_GRAPH_UNIFORM:
+		return { shader_stages, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, true, false };
+	case EV_GRAPH_VERTEX:
+		return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, true, false };
+	case EV_GRAPH_INDIRECT:
+		return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, true, false };
+	case EV_GRAPH_TRANSFER_SRC:
+		return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true, false };
+	case EV_GRAPH_TRANSFER_DST:
+		return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false, true };
+	}
+	return {};
+}
+
+static VkImageUsageFlags access_usage(Graph_Access access) {
+	switch (access) {
+	case EV_GRAPH_COLOR_ATTACHMENT: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	case EV_GRAPH_DEPTH_ATTACHMENT: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	case EV_GRAPH_SAMPLED: return VK_IMAGE_USAGE_SAMPLED_BIT;
+	case EV_GRAPH_STORAGE_READ:
+	case EV_GRAPH_STORAGE_WRITE: return VK_IMAGE_USAGE_STORAGE_BIT;
+	case EV_GRAPH_TRANSFER_SRC: return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	case EV_GRAPH_TRANSFER_DST: return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	default: return 0;
+	}
+}
+
+Render_Graph* create_render_graph(GpuIF gpu_if) {
+	Render_Graph* graph = EV_ALLOC(Render_Graph, 1);
+	memset(graph, 0, sizeof(*graph));
+	graph->gpu_if = gpu_if;
+	return graph;
+}
+
+void destroy_render_graph(Render_Graph* graph) {
+	VkDevice device = graph->gpu_if.device;
+	for (uint32_t x = 0; x < graph->framebuffer_count; x++) {
+		vkDestroyFramebuffer(device, graph->framebuffers[x].framebuffer, NULL);
+	}
+	for (uint32_t x = 0; x < graph->pass_count; x++) {
+		if (graph->passes[x].renderpass) vkDestroyRenderPass(device, graph->passes[x].renderpass, NULL);
+	}
+	for (uint32_t x = 0; x < graph->resource_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[x];
+		if (!resource->is_image || resource->imported || !resource->image) continue;
+		vkDestroyImageView(device, resource->view, NULL);
+		vkDestroyImage(device, resource->image, NULL);
+	}
+	for (uint32_t x = 0; x < graph->slot_count; x++) {
+		vkFreeMemory(device, graph->slots[x].memory, NULL);
+	}
+	EV_FREE(graph);
+}
+
+static Graph_Resource add_resource(Render_Graph* graph, const char* name) {
+	EV_CHECK(!graph->compiled && graph->resource_count < EV_GRAPH_MAX_RESOURCES);
+	Graph_Resource resource = graph->resource_count++;
+	Graph_Resource_Info* info = &graph->resources[resource];
+	*info = {};
+	info->name = name;
+	info->first_pass = UINT32_MAX;
+	info->slot = UINT32_MAX;
+	return resource;
+}
+
+Graph_Resource graph_create_image(Render_Graph* graph, const char* name, Graph_Image_Desc desc) {
+	Graph_Resource resource = add_resource(graph, name);
+	Graph_Resource_Info* info = &graph->resources[resource];
+	info->is_image = true;
+	info->format = desc.format;
+	info->extent = desc.extent;
+	return resource;
+}
+
+Graph_Resource graph_import_image(Render_Graph* graph, const char* name, VkFormat format, VkExtent2D extent,
+	VkImageLayout initial_layout, VkPipelineStageFlags initial_stages, VkImageLayout final_layout) {
+	Graph_Resource resource = add_resource(graph, name);
+	Graph_Resource_Info* info = &graph->resources[resource];
+	info->is_image = true;
+	info->imported = true;
+	info->exported = final_layout != VK_IMAGE_LAYOUT_UNDEFINED;
+	info->format = format;
+	info->extent = extent;
+	info->initial_layout = initial_layout;
+	info->initial_stages = initial_stages;
+	info->final_layout = final_layout;
+	return resource;
+}
+
+Graph_Resource graph_import_buffer(Render_Graph* graph, const char* name, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, bool exported) {
+	Graph_Resource resource = add_resource(graph, name);
+	Graph_Resource_Info* info = &graph->resources[resource];
+	info->imported = true;
+	info->exported = exported;
+	info->buffer = buffer;
+	info->offset = offset;
+	info->size = size;
+	return resource;
+}
+
+void graph_set_image(Render_Graph* graph, Graph_Resource resource, VkImage image, VkImageView view, VkExtent2D extent) {
+	Graph_Resource_Info* info = &graph->resources[resource];
+	EV_CHECK(info->is_image && info->imported);
+	info->image = image;
+	info->view = view;
+	info->extent = extent;
+}
+
+Graph_Pass graph_add_pass(Render_Graph* graph, const char* name, Graph_Pass_Kind kind, Graph_Pass_Fn* fn, void* user_data) {
+	EV_CHECK(!graph->compiled && graph->pass_count < EV_GRAPH_MAX_PASSES);
+	Graph_Pass pass = graph->pass_count++;
+	Graph_Pass_Info* info = &graph->passes[pass];
+	*info = {};
+	info->name = name;
+	info->kind = kind;
+	info->fn = fn;
+	info->user_data = user_data;
+	return pass;
+}
+
+static void add_use(Render_Graph* graph, Graph_Pass pass, Graph_Use use) {
+	Graph_Pass_Info* info = &graph->passes[pass];
+	EV_CHECK(!graph->compiled && info->use_count < EV_GRAPH_MAX_PASS_ACCESSES);
+	for (uint32_t x = 0; x < info->use_count; x++) {
+		EV_CHECK(info->uses[x].resource != use.resource);
+	}
+	info->uses[info->use_count++] = use;
+}
+
+void graph_use(Render_Graph* graph, Graph_Pass pass, Graph_Resource resource, Graph_Access access) {
+	EV_CHECK(access != EV_GRAPH_COLOR_ATTACHMENT && access != EV_GRAPH_DEPTH_ATTACHMENT);
+	Graph_Use use = {};
+	use.resource = resource;
+	use.access = access;
+	use.load_op = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	add_use(graph, pass, use);
+}
+
+void graph_attachment(Render_Graph* graph, Graph_Pass pass, Graph_Resource resource, VkAttachmentLoadOp load_op, VkClearValue clear) {
+	EV_CHECK(graph->passes[pass].kind == EV_GRAPH_PASS_RASTER && graph->resources[resource].is_image);
+	Graph_Use use = {};
+	use.resource = resource;
+	use.access = is_depth_format(graph->resources[resource].format) ? EV_GRAPH_DEPTH_ATTACHMENT : EV_GRAPH_COLOR_ATTACHMENT;
+	use.load_op = load_op;
+	use.clear = clear;
+	add_use(graph, pass, use);
+}
+
+void graph_side_effects(Render_Graph* graph, Graph_Pass pass) {
+	graph->passes[pass].side_effects = true;
+}
+
+void graph_secondary_contents(Render_Graph* graph, Graph_Pass pass) {
+	graph->passes[pass].secondary = true;
+}
+
+static void cull_passes(Render_Graph* graph) {
+	bool needed[EV_GRAPH_MAX_RESOURCES];
+	for (uint32_t x = 0; x < graph->resource_count; x++) {
+		needed[x] = graph->resources[x].exported;
+	}
+
+	for (uint32_t p = graph->pass_count; p-- > 0;) {
+		Graph_Pass_Info* pass = &graph->passes[p];
+		bool alive = pass->side_effects;
+		for (uint32_t x = 0; x < pass->use_count; x++) {
+			Graph_Access_Info info = access_info(&pass->uses[x], pass->kind);
+			if (info.writes && needed[pass->uses[x].resource]) alive = true;
+		}
+		if (!alive) {
+			pass->culled = true;
+			graph->culled_count++;
+			continue;
+		}
+
+		for (uint32_t x = 0; x < pass->use_count; x++) {
+			Graph_Use* use = &pass->uses[x];
+			Graph_Access_Info info = access_info(use, pass->kind);
+			bool overwrites = use->access == EV_GRAPH_COLOR_ATTACHMENT || use->access == EV_GRAPH_DEPTH_ATTACHMENT || use->access == EV_GRAPH_TRANSFER_DST;
+			if (info.reads) needed[use->resource] = true;
+			else if (overwrites && graph->resources[use->resource].is_image && !graph->resources[use->resource].exported) needed[use->resource] = false;
+		}
+	}
+}
+
+static void compute_lifetimes(Render_Graph* graph) {
+	for (uint32_t p = 0; p < graph->pass_count; p++) {
+		Graph_Pass_Info* pass = &graph->passes[p];
+		if (pass->culled) continue;
+		for (uint32_t x = 0; x < pass->use_count; x++) {
+			Graph_Resource_Info* resource = &graph->resources[pass->uses[x].resource];
+			if (resource->first_pass == UINT32_MAX) resource->first_pass = p;
+			resource->last_pass = p;
+			resource->usage |= access_usage(pass->uses[x].access);
+		}
+	}
+}
+
+static void create_transient_images(Render_Graph* graph) {
+	Graph_Resource order[EV_GRAPH_MAX_RESOURCES];
+	VkMemoryRequirements requirements[EV_GRAPH_MAX_RESOURCES];
+	uint32_t order_count = 0;
+	VkImageUsageFlags attachment_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+	for (uint32_t x = 0; x < graph->resource_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[x];
+		if (!resource->is_image || resource->imported || resource->first_pass == UINT32_MAX) continue;
+		if (!(resource->usage & ~attachment_usage)) resource->usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+		VkImageCreateInfo image_create_info = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		image_create_info.imageType = VK_IMAGE_TYPE_2D;
+		image_create_info.format = resource->format;
+		image_create_info.extent = { resource->extent.width, resource->extent.height, 1 };
+		image_create_info.mipLevels = 1;
+		image_create_info.arrayLayers = 1;
+		image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_create_info.usage = resource->usage;
+		image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		EV_CHECK_VKRESULT(vkCreateImage(graph->gpu_if.device, &image_create_info, NULL, &resource->image));
+		vkGetImageMemoryRequirements(graph->gpu_if.device, resource->image, &requirements[x]);
+		graph->transient_size += requirements[x].size;
+
+		uint32_t y = order_count++;
+		while (y > 0 && graph->resources[order[y - 1]].first_pass > resource->first_pass) {
+			order[y] = order[y - 1];
+			y--;
+		}
+		order[y] = x;
+	}
+
+	for (uint32_t x = 0; x < order_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[order[x]];
+		VkMemoryRequirements* reqs = &requirements[order[x]];
+		bool lazy = resource->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+		uint32_t slot_ix = graph->slot_count;
+		for (uint32_t y = 0; y < graph->slot_count; y++) {
+			Graph_Slot* slot = &graph->slots[y];
+			if (slot->last_pass < resource->first_pass && (slot->memory_bits & reqs->memoryTypeBits) && slot->lazy == lazy) {
+				slot_ix = y;
+				break;
+			}
+		}
+		if (slot_ix == graph->slot_count) {
+			graph->slots[graph->slot_count++] = { VK_NULL_HANDLE, 0, reqs->memoryTypeBits, lazy, 0, UINT32_MAX };
+		}
+		Graph_Slot* slot = &graph->slots[slot_ix];
+		if (reqs->size > slot->size) slot->size = reqs->size;
+		slot->memory_bits &= reqs->memoryTypeBits;
+		slot->last_pass = resource->last_pass;
+		resource->slot = slot_ix;
+	}
+
+	for (uint32_t x = 0; x < graph->slot_count; x++) {
+		Graph_Slot* slot = &graph->slots[x];
+		VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		if (slot->lazy && find_memory_index(graph->gpu_if.gpu, slot->memory_bits, properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != UINT32_MAX) {
+			properties |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+		}
+		slot->memory = allocate_memory(graph->gpu_if, slot->size, slot->memory_bits, properties);
+		slot->last_pass = 0;
+		graph->aliased_size += slot->size;
+	}
+
+	for (uint32_t x = 0; x < order_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[order[x]];
+		EV_CHECK_VKRESULT(vkBindImageMemory(graph->gpu_if.device, resource->image, graph->slots[resource->slot].memory, 0));
+
+		VkImageViewCreateInfo view_create_info = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		view_create_info.image = resource->image;
+		view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		view_create_info.format = resource->format;
+		view_create_info.subresourceRange = { format_aspect(resource->format), 0, 1, 0, 1 };
+		EV_CHECK_VKRESULT(vkCreateImageView(graph->gpu_if.device, &view_create_info, NULL, &resource->view));
+	}
+}
+
+static void create_pass_renderpass(Render_Graph* graph, Graph_Pass p) {
+	Graph_Pass_Info* pass = &graph->passes[p];
+	VkAttachmentDescription descriptions[EV_GRAPH_MAX_ATTACHMENTS];
+	VkAttachmentReference color_refs[EV_GRAPH_MAX_ATTACHMENTS];
+	VkAttachmentReference depth_ref = {};
+	uint32_t color_count = 0;
+	bool has_depth = false;
+
+	for (uint32_t x = 0; x < pass->use_count; x++) {
+		Graph_Use* use = &pass->uses[x];
+		if (use->access != EV_GRAPH_COLOR_ATTACHMENT && use->access != EV_GRAPH_DEPTH_ATTACHMENT) continue;
+		EV_CHECK(pass->attachment_count < EV_GRAPH_MAX_ATTACHMENTS);
+
+		Graph_Resource_Info* resource = &graph->resources[use->resource];
+		bool stored = resource->exported || resource->last_pass > p;
+		uint32_t ix = pass->attachment_count++;
+		VkImageLayout layout = access_info(use, pass->kind).layout;
+		descriptions[ix] = {};
+		descriptions[ix].format = resource->format;
+		descriptions[ix].samples = VK_SAMPLE_COUNT_1_BIT;
+		descriptions[ix].loadOp = use->load_op;
+		descriptions[ix].storeOp = stored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		descriptions[ix].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		descriptions[ix].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		descriptions[ix].initialLayout = layout;
+		descriptions[ix].finalLayout = layout;
+		pass->attachments[ix] = use->resource;
+		pass->clears[ix] = use->clear;
+
+		if (use->access == EV_GRAPH_DEPTH_ATTACHMENT) {
+			EV_CHECK(!has_depth);
+			has_depth = true;
+			depth_ref = { ix, layout };
+		}
+		else {
+			color_refs[color_count++] = { ix, layout };
+		}
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = color_count;
+	subpass.pColorAttachments = color_refs;
+	subpass.pDepthStencilAttachment = has_depth ? &depth_ref : NULL;
+
+	VkRenderPassCreateInfo renderpass_create_info = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+	renderpass_create_info.attachmentCount = pass->attachment_count;
+	renderpass_create_info.pAttachments = descriptions;
+	renderpass_create_info.subpassCount = 1;
+	renderpass_create_info.pSubpasses = &subpass;
+	EV_CHECK_VKRESULT(vkCreateRenderPass(graph->gpu_if.device, &renderpass_create_info, NULL, &pass->renderpass));
+}
+
+static void push_barrier(Render_Graph* graph, Graph_Batch* batch, Graph_Barrier barrier, VkPipelineStageFlags src_stages, VkPipelineStageFlags dst_stages) {
+	EV_CHECK(graph->barrier_count < EV_GRAPH_MAX_BARRIERS);
+	graph->barriers[graph->barrier_count++] = barrier;
+	batch->barrier_count++;
+	batch->src_stages |= src_stages ? src_stages : (VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	batch->dst_stages |= dst_stages;
+}
+
+static void build_pass_barriers(Render_Graph* graph, Graph_State* states, Graph_State* slot_states) {
+	graph->barrier_count = 0;
+	for (uint32_t x = 0; x < graph->resource_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[x];
+		states[x] = {};
+		states[x].layout = resource->imported ? resource->initial_layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		states[x].write_stages = resource->initial_stages;
+	}
+
+	for (uint32_t p = 0; p < graph->pass_count; p++) {
+		Graph_Pass_Info* pass = &graph->passes[p];
+		if (pass->culled) continue;
+		pass->barriers = { graph->barrier_count, 0, 0, 0 };
+
+		for (uint32_t x = 0; x < pass->use_count; x++) {
+			Graph_Use* use = &pass->uses[x];
+			Graph_Resource_Info* resource = &graph->resources[use->resource];
+			Graph_State* state = &states[use->resource];
+			Graph_Access_Info info = access_info(use, pass->kind);
+			bool first_transient_use = resource->slot != UINT32_MAX && resource->first_pass == p;
+
+			if (first_transient_use) *state = slot_states[resource->slot];
+			bool layout_change = resource->is_image && (state->layout != info.layout || first_transient_use);
+			bool hazard = info.writes ? (state->write_stages || state->read_stages) : (state->write_stages && (info.stages & ~state->visible_stages));
+
+			if (layout_change || hazard) {
+				Graph_Barrier barrier = { use->resource, state->write_access, info.access,
+					first_transient_use ? VK_IMAGE_LAYOUT_UNDEFINED : state->layout, resource->is_image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED };
+				push_barrier(graph, &pass->barriers, barrier, state->write_stages | state->read_stages, info.stages);
+			}
+
+			state->layout = info.layout;
+			if (info.writes) {
+				state->write_stages = info.stages;
+				state->write_access = info.access;
+				state->read_stages = 0;
+				state->visible_stages = 0;
+			}
+			else {
+				state->read_stages |= info.stages;
+				state->visible_stages |= info.stages;
+			}
+		}
+
+		for (uint32_t x = 0; x < pass->use_count; x++) {
+			Graph_Resource_Info* resource = &graph->resources[pass->uses[x].resource];
+			if (resource->slot != UINT32_MAX && resource->last_pass == p) {
+				slot_states[resource->slot] = states[pass->uses[x].resource];
+			}
+		}
+	}
+}
+
+static void build_barriers(Render_Graph* graph) {
+	Graph_State states[EV_GRAPH_MAX_RESOURCES];
+	Graph_State slot_states[EV_GRAPH_MAX_RESOURCES] = {};
+	build_pass_barriers(graph, states, slot_states);
+	build_pass_barriers(graph, states, slot_states);
+
+	graph->final_barriers = { graph->barrier_count, 0, 0, 0 };
+	for (uint32_t x = 0; x < graph->resource_count; x++) {
+		Graph_Resource_Info* resource = &graph->resources[x];
+		Graph_State* state = &states[x];
+		if (!resource->is_image || !resource->exported || resource->first_pass == UINT32_MAX || state->layout == resource->final_layout) continue;
+		Graph_Barrier barrier = { x, state->write_access, 0, state->layout, resource->final_layout };
+		push_barrier(graph, &graph->final_barriers, barrier, state->write_stages | state->read_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	}
+}
+
+void compile_render_graph(Render_Graph* graph) {
+	EV_CHECK(!graph->compiled);
+	cull_passes(graph);
+	compute_lifetimes(graph);
+	create_transient_images(graph);
+	for (uint32_t p = 0; p < graph->pass_count; p++) {
+		if (!graph->passes[p].culled && graph->passes[p].kind == EV_GRAPH_PASS_RASTER) create_pass_renderpass(graph, p);
+	}
+	build_barriers(graph);
+	graph->compiled = true;
+}
+
+static void record_batch(Render_Graph* graph, VkCommandBuffer cmd_buffer, Graph_Batch* batch) {
+	if (batch->barrier_count == 0) return;
+	VkImageMemoryBarrier image_barriers[EV_GRAPH_MAX_RESOURCES];
+	VkBufferMemoryBarrier buffer_barriers[EV_GRAPH_MAX_RESOURCES];
+	uint32_t image_count = 0;
+	uint32_t buffer_count = 0;
+
+	for (uint32_t x = 0; x < batch->barrier_count; x++) {
+		Graph_Barrier* barrier = &graph->barriers[batch->first_barrier + x];
+		Graph_Resource_Info* resource = &graph->resources[barrier->resource];
+		if (resource->is_image) {
+			VkImageMemoryBarrier* image_barrier = &image_barriers[image_count++];
+			*image_barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			image_barrier->srcAccessMask = barrier->src_access;
+			image_barrier->dstAccessMask = barrier->dst_access;
+			image_barrier->oldLayout = barrier->old_layout;
+			image_barrier->newLayout = barrier->new_layout;
+			image_barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barrier->image = resource->image;
+			image_barrier->subresourceRange = { format_aspect(resource->format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+		}
+		else {
+			VkBufferMemoryBarrier* buffer_barrier = &buffer_barriers[buffer_count++];
+			*buffer_barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+			buffer_barrier->srcAccessMask = barrier->src_access;
+			buffer_barrier->dstAccessMask = barrier->dst_access;
+			buffer_barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			buffer_barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			buffer_barrier->buffer = resource->buffer;
+			buffer_barrier->offset = resource->offset;
+			buffer_barrier->size = resource->size;
+		}
+	}
+	vkCmdPipelineBarrier(cmd_buffer, batch->src_stages, batch->dst_stages, 0, 0, NULL, buffer_count, buffer_barriers, image_count, image_barriers);
+}
+
+static VkFramebuffer find_framebuffer(Render_Graph* graph, Graph_Pass p, VkExtent2D extent) {
+	Graph_Pass_Info* pass = &graph->passes[p];
+	VkImageView views[EV_GRAPH_MAX_ATTACHMENTS];
+	for (uint32_t x = 0; x < pass->attachment_count; x++) {
+		views[x] = graph->resources[pass->attachments[x]].view;
+	}
+
+	for (uint32_t x = 0; x < graph->framebuffer_count; x++) {
+		Graph_Framebuffer* cached = &graph->framebuffers[x];
+		if (cached->pass == p && memcmp(cached->views, views, sizeof(VkImageView) * pass->attachment_count) == 0) return cached->framebuffer;
+	}
+
+	EV_CHECK(graph->framebuffer_count < EV_GRAPH_MAX_FRAMEBUFFERS);
+	Graph_Framebuffer* cached = &graph->framebuffers[graph->framebuffer_count++];
+	cached->pass = p;
+	memcpy(cached->views, views, sizeof(VkImageView) * pass->attachment_count);
+
+	VkFramebufferCreateInfo framebuffer_create_info = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+	framebuffer_create_info.renderPass = pass->renderpass;
+	framebuffer_create_info.attachmentCount = pass->attachment_count;
+	framebuffer_create_info.pAttachments = views;
+	framebuffer_create_info.width = extent.width;
+	framebuffer_create_info.height = extent.height;
+	framebuffer_create_info.layers = 1;
+	EV_CHECK_VKRESULT(vkCreateFramebuffer(graph->gpu_if.device, &framebuffer_create_info, NULL, &cached->framebuffer));
+	return cached->framebuffer;
+}
+
+void execute_render_graph(Render_Graph* graph, VkCommandBuffer cmd_buffer) {
+	EV_CHECK(graph->compiled);
+	for (uint32_t p = 0; p < graph->pass_count; p++) {
+		Graph_Pass_Info* pass = &graph->passes[p];
+		if (pass->culled) continue;
+		record_batch(graph, cmd_buffer, &pass->barriers);
+
+		Graph_Pass_Context context = {};
+		if (pass->kind == EV_GRAPH_PASS_RASTER) {
+			context.renderpass = pass->renderpass;
+			context.extent = graph->resources[pass->attachments[0]].extent;
+			context.framebuffer = find_framebuffer(graph, p, context.extent);
+
+			VkRenderPassBeginInfo renderpass_begin_info = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+			renderpass_begin_info.renderPass = context.renderpass;
+			renderpass_begin_info.framebuffer = context.framebuffer;
+			renderpass_begin_info.renderArea = { {0, 0}, context.extent };
+			renderpass_begin_info.clearValueCount = pass->attachment_count;
+			renderpass_begin_info.pClearValues = pass->clears;
+			vkCmdBeginRenderPass(cmd_buffer, &renderpass_begin_info, pass->secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+			pass->fn(cmd_buffer, &context, pass->user_data);
+			vkCmdEndRenderPass(cmd_buffer);
+		}
+		else {
+			pass->fn(cmd_buffer, &context, pass->user_data);
+		}
+	}
+	record_batch(graph, cmd_buffer, &graph->final_barriers);
+}
+
+void reset_graph_framebuffers(Render_Graph* graph, Deletion_Queue* deletions) {
+	for (uint32_t x = 0; x < graph->framebuffer_count; x++) {
+		defer_destroy_framebuffer(deletions, graph->framebuffers[x].framebuffer);
+	}
+	graph->framebuffer_count = 0;
+}
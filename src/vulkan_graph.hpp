@@ -0,0 +1,179 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_deletion.hpp"
+
+#define EV_GRAPH_MAX_PASSES 32
+#define EV_GRAPH_MAX_RESOURCES 64
+#define EV_GRAPH_MAX_PASS_ACCESSES 16
+#define EV_GRAPH_MAX_ATTACHMENTS 8
+#define EV_GRAPH_MAX_FRAMEBUFFERS 32
+#define EV_GRAPH_MAX_BARRIERS (EV_GRAPH_MAX_PASSES * EV_GRAPH_MAX_PASS_ACCESSES + EV_GRAPH_MAX_RESOURCES)
+
+typedef uint32_t Graph_Resource;
+typedef uint32_t Graph_Pass;
+
+enum Graph_Pass_Kind
+{
+	EV_GRAPH_PASS_RASTER,
+	EV_GRAPH_PASS_COMPUTE,
+	EV_GRAPH_PASS_TRANSFER,
+};
+
+enum Graph_Access
+{
+	EV_GRAPH_COLOR_ATTACHMENT,
+	EV_GRAPH_DEPTH_ATTACHMENT,
+	EV_GRAPH_SAMPLED,
+	EV_GRAPH_STORAGE_READ,
+	EV_GRAPH_STORAGE_WRITE,
+	EV_GRAPH_UNIFORM,
+	EV_GRAPH_VERTEX,
+	EV_GRAPH_INDIRECT,
+	EV_GRAPH_TRANSFER_SRC,
+	EV_GRAPH_TRANSFER_DST,
+};
+
+struct Graph_Pass_Context
+{
+	VkRenderPass renderpass;
+	VkFramebuffer framebuffer;
+	VkExtent2D extent;
+};
+
+typedef void Graph_Pass_Fn(VkCommandBuffer cmd_buffer, const Graph_Pass_Context* context, void* user_data);
+
+struct Graph_Image_Desc
+{
+	VkExtent2D extent;
+	VkFormat format;
+};
+
+struct Graph_Resource_Info
+{
+	const char* name;
+	bool is_image;
+	bool imported;
+	bool exported;
+
+	VkImage image;
+	VkImageView view;
+	VkFormat format;
+	VkExtent2D extent;
+	VkImageUsageFlags usage;
+	VkImageLayout initial_layout;
+	VkPipelineStageFlags initial_stages;
+	VkImageLayout final_layout;
+
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+
+	uint32_t first_pass;
+	uint32_t last_pass;
+	uint32_t slot;
+};
+
+struct Graph_Use
+{
+	Graph_Resource resource;
+	Graph_Access access;
+	VkAttachmentLoadOp load_op;
+	VkClearValue clear;
+};
+
+struct Graph_Barrier
+{
+	Graph_Resource resource;
+	VkAccessFlags src_access;
+	VkAccessFlags dst_access;
+	VkImageLayout old_layout;
+	VkImageLayout new_layout;
+};
+
+struct Graph_Batch
+{
+	uint32_t first_barrier;
+	uint32_t barrier_count;
+	VkPipelineStageFlags src_stages;
+	VkPipelineStageFlags dst_stages;
+};
+
+struct Graph_Pass_Info
+{
+	const char* name;
+	Graph_Pass_Kind kind;
+	Graph_Pass_Fn* fn;
+	void* user_data;
+	bool side_effects;
+	bool secondary;
+	bool culled;
+
+	Graph_Use uses[EV_GRAPH_MAX_PASS_ACCESSES];
+	uint32_t use_count;
+
+	VkRenderPass renderpass;
+	VkExtent2D extent;
+	uint32_t attachments[EV_GRAPH_MAX_ATTACHMENTS];
+	VkClearValue clears[EV_GRAPH_MAX_ATTACHMENTS];
+	uint32_t attachment_count;
+	Graph_Batch barriers;
+};
+
+struct Graph_Slot
+{
+	VkDeviceMemory memory;
+	VkDeviceSize size;
+	uint32_t memory_bits;
+	bool lazy;
+	uint32_t last_pass;
+	Graph_Resource last_resource;
+};
+
+struct Graph_Framebuffer
+{
+	Graph_Pass pass;
+	VkImageView views[EV_GRAPH_MAX_ATTACHMENTS];
+	VkFramebuffer framebuffer;
+};
+
+struct Render_Graph
+{
+	GpuIF gpu_if;
+	Graph_Resource_Info resources[EV_GRAPH_MAX_RESOURCES];
+	uint32_t resource_count;
+	Graph_Pass_Info passes[EV_GRAPH_MAX_PASSES];
+	uint32_t pass_count;
+
+	Graph_Barrier barriers[EV_GRAPH_MAX_BARRIERS];
+	uint32_t barrier_count;
+	Graph_Batch final_barriers;
+
+	Graph_Slot slots[EV_GRAPH_MAX_RESOURCES];
+	uint32_t slot_count;
+	Graph_Framebuffer framebuffers[EV_GRAPH_MAX_FRAMEBUFFERS];
+	uint32_t framebuffer_count;
+
+	uint32_t culled_count;
+	VkDeviceSize transient_size;
+	VkDeviceSize aliased_size;
+	bool compiled;
+};
+
+Render_Graph* create_render_graph(GpuIF gpu_if);
+void destroy_render_graph(Render_Graph* graph);
+Graph_Resource graph_create_image(Render_Graph* graph, const char* name, Graph_Image_Desc desc);
+Graph_Resource graph_import_image(Render_Graph* graph, const char* name, VkFormat format, VkExtent2D extent,
+	VkImageLayout initial_layout, VkPipelineStageFlags initial_stages, VkImageLayout final_layout);
+Graph_Resource graph_import_buffer(Render_Graph* graph, const char* name, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, bool exported);
+void graph_set_image(Render_Graph* graph, Graph_Resource resource, VkImage image, VkImageView view, VkExtent2D extent);
+Graph_Pass graph_add_pass(Render_Graph* graph, const char* name, Graph_Pass_Kind kind, Graph_Pass_Fn* fn, void* user_data);
+void graph_use(Render_Graph* graph, Graph_Pass pass, Graph_Resource resource, Graph_Access access);
+void graph_attachment(Render_Graph* graph, Graph_Pass pass, Graph_Resource resource, VkAttachmentLoadOp load_op, VkClearValue clear);
+void graph_side_effects(Render_Graph* graph, Graph_Pass pass);
+void graph_secondary_contents(Render_Graph* graph, Graph_Pass pass);
+void compile_render_graph(Render_Graph* graph);
+void execute_render_graph(Render_Graph* graph, VkCommandBuffer cmd_buffer);
+void reset_graph_framebuffers(Render_Graph* graph, Deletion_Queue* deletions);
@@ -0,0 +1,447 @@
+#include "vulkan_memory.hpp"
+#include "vulkan_resource.hpp"
+
+#define EV_NODE_NONE 0xFFFFFFFF
+
+enum Node_State
+{
+	EV_NODE_UNUSED,
+	EV_NODE_FREE,
+	EV_NODE_SPLIT,
+	EV_NODE_ALLOCATED,
+};
+
+static uint32_t log2_floor(VkDeviceSize x) {
+	uint32_t result = 0;
+	while (x >>= 1) result++;
+	return result;
+}
+
+static VkDeviceSize next_pow2(VkDeviceSize x) {
+	VkDeviceSize result = 1;
+	while (result < x) result <<= 1;
+	return result;
+}
+
+static Memory_Heap_Stats* type_heap(Device_Allocator* allocator, uint32_t memory_type) {
+	return &allocator->heaps[allocator->memory_properties.memoryTypes[memory_type].heapIndex];
+}
+
+static uint32_t find_type_index(Device_Allocator* allocator, uint32_t required_memory_bits, VkMemoryPropertyFlags properties, VkDeviceSize size) {
+	uint32_t fallback = UINT32_MAX;
+	for (uint32_t x = 0; x < allocator->memory_properties.memoryTypeCount; x++) {
+		bool is_required_memory_type = required_memory_bits & (1 << x);
+		bool has_required_properties = (allocator->memory_properties.memoryTypes[x].propertyFlags & properties) == properties;
+		if (!is_required_memory_type || !has_required_properties) continue;
+
+		Memory_Heap_Stats* heap = type_heap(allocator, x);
+		if (heap->usage + size <= heap->budget) return x;
+		if (fallback == UINT32_MAX) fallback = x;
+	}
+	return fallback;
+}
+
+static void track_allocation(Device_Allocator* allocator, uint32_t memory_type, VkDeviceSize size) {
+	Memory_Heap_Stats* heap = type_heap(allocator, memory_type);
+	heap->used_bytes += size;
+	heap->allocation_count++;
+	allocator->allocation_counts[memory_type]++;
+	if (heap->used_bytes > heap->frame_peak) heap->frame_peak = heap->used_bytes;
+	if (heap->used_bytes > heap->peak) heap->peak = heap->used_bytes;
+}
+
+static void untrack_allocation(Device_Allocator* allocator, uint32_t memory_type, VkDeviceSize size) {
+	Memory_Heap_Stats* heap = type_heap(allocator, memory_type);
+	heap->used_bytes -= size;
+	heap->allocation_count--;
+	allocator->allocation_counts[memory_type]--;
+}
+
+static bool is_host_visible(Device_Allocator* allocator, uint32_t memory_type) {
+	return allocator->memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+}
+
+static VkDeviceMemory allocate_device_block(GpuIF gpu_if, uint32_t memory_type, VkDeviceSize size, uint8_t** mapped) {
+	VkDeviceMemory memory = allocate_memory(gpu_if, size, 1 << memory_type, 0);
+	gpu_if.allocator->device_allocation_count++;
+	Memory_Heap_Stats* heap = type_heap(gpu_if.allocator, memory_type);
+	heap->block_bytes += size;
+	heap->usage += size;
+
+	*mapped = NULL;
+	if (is_host_visible(gpu_if.allocator, memory_type)) {
+		EV_CHECK_VKRESULT(vkMapMemory(gpu_if.device, memory, 0, VK_WHOLE_SIZE, 0, (void**)mapped));
+	}
+	return memory;
+}
+
+static void free_device_block(GpuIF gpu_if, uint32_t memory_type, VkDeviceMemory memory, VkDeviceSize size) {
+	vkFreeMemory(gpu_if.device, memory, NULL);
+	gpu_if.allocator->device_allocation_count--;
+	Memory_Heap_Stats* heap = type_heap(gpu_if.allocator, memory_type);
+	heap->block_bytes -= size;
+	heap->usage = heap->usage > size ? heap->usage - size : 0;
+}
+
+static void push_free_node(Buddy_Block* block, uint32_t level, uint32_t node) {
+	block->state[node] = EV_NODE_FREE;
+	block->prev[node] = EV_NODE_NONE;
+	block->next[node] = block->free_heads[level];
+	if (block->free_heads[level] != EV_NODE_NONE) block->prev[block->free_heads[level]] = node;
+	block->free_heads[level] = node;
+}
+
+static void unlink_free_node(Buddy_Block* block, uint32_t level, uint32_t node) {
+	if (block->prev[node] != EV_NODE_NONE) block->next[block->prev[node]] = block->next[node];
+	else block->free_heads[level] = block->next[node];
+	if (block->next[node] != EV_NODE_NONE) block->prev[block->next[node]] = block->prev[node];
+}
+
+static uint32_t create_buddy_block(GpuIF gpu_if, Memory_Type_Pool* pool, uint32_t memory_type) {
+	uint32_t node_count = (1U << pool->level_count) - 1;
+
+	pool->blocks = EV_REALLOC(Buddy_Block, pool->blocks, pool->block_count + 1);
+	Buddy_Block* block = &pool->blocks[pool->block_count];
+	block->memory = allocate_device_block(gpu_if, memory_type, pool->block_size, &block->mapped);
+	block->state = EV_ALLOC(uint8_t, node_count);
+	block->next = EV_ALLOC(uint32_t, node_count);
+	block->prev = EV_ALLOC(uint32_t, node_count);
+	block->free_heads = EV_ALLOC(uint32_t, pool->level_count);
+	block->used = 0;
+
+	for (uint32_t x = 0; x < node_count; x++) block->state[x] = EV_NODE_UNUSED;
+	for (uint32_t x = 0; x < pool->level_count; x++) block->free_heads[x] = EV_NODE_NONE;
+	push_free_node(block, 0, 0);
+
+	return pool->block_count++;
+}
+
+static uint32_t buddy_alloc(Buddy_Block* block, uint32_t level) {
+	uint32_t current = level;
+	while (block->free_heads[current] == EV_NODE_NONE) {
+		if (current == 0) return EV_NODE_NONE;
+		current--;
+	}
+
+	uint32_t node = block->free_heads[current];
+	unlink_free_node(block, current, node);
+	while (current < level) {
+		block->state[node] = EV_NODE_SPLIT;
+		push_free_node(block, current + 1, 2 * node + 2);
+		node = 2 * node + 1;
+		current++;
+	}
+	block->state[node] = EV_NODE_ALLOCATED;
+	return node;
+}
+
+static void buddy_free(Buddy_Block* block, uint32_t node) {
+	uint32_t level = log2_floor(node + 1);
+	while (level > 0) {
+		uint32_t buddy = (node & 1) ? node + 1 : node - 1;
+		if (block->state[buddy] != EV_NODE_FREE) break;
+
+		unlink_free_node(block, level, buddy);
+		block->state[buddy] = EV_NODE_UNUSED;
+		block->state[node] = EV_NODE_UNUSED;
+		node = (node - 1) / 2;
+		level--;
+	}
+	push_free_node(block, level, node);
+}
+
+static Memory_Allocation allocate_dedicated(GpuIF gpu_if, uint32_t memory_type, VkDeviceSize size) {
+	Memory_Allocation allocation = {};
+	allocation.kind = EV_ALLOCATION_DEDICATED;
+	allocation.memory_type = memory_type;
+	allocation.size = size;
+	allocation.memory = allocate_device_block(gpu_if, memory_type, size, &allocation.mapped);
+	gpu_if.allocator->dedicated_counts[memory_type]++;
+	return allocation;
+}
+
+static Memory_Allocation allocate_buddy(GpuIF gpu_if, Memory_Type_Pool* pool, uint32_t memory_type, VkDeviceSize node_size) {
+	uint32_t level = log2_floor(pool->block_size / node_size);
+
+	uint32_t block_ix = EV_NODE_NONE;
+	uint32_t node = EV_NODE_NONE;
+	for (uint32_t x = 0; x < pool->block_count; x++) {
+		node = buddy_alloc(&pool->blocks[x], level);
+		if (node != EV_NODE_NONE) {
+			block_ix = x;
+			break;
+		}
+	}
+	if (node == EV_NODE_NONE) {
+		block_ix = create_buddy_block(gpu_if, pool, memory_type);
+		node = buddy_alloc(&pool->blocks[block_ix], level);
+	}
+
+	Buddy_Block* block = &pool->blocks[block_ix];
+	block->used += node_size;
+
+	Memory_Allocation allocation = {};
+	allocation.kind = EV_ALLOCATION_BUDDY;
+	allocation.memory = block->memory;
+	allocation.offset = (node - ((1U << level) - 1)) * node_size;
+	allocation.size = node_size;
+	allocation.mapped = block->mapped ? block->mapped + allocation.offset : NULL;
+	allocation.memory_type = memory_type;
+	allocation.block = block_ix;
+	allocation.node = node;
+	return allocation;
+}
+
+static Memory_Allocation allocate_linear(GpuIF gpu_if, Memory_Type_Pool* pool, uint32_t memory_type, VkMemoryRequirements requirements) {
+	Linear_Page* page = pool->page_count ? &pool->pages[pool->current_page] : NULL;
+	VkDeviceSize offset = page ? EV_ALIGN_UP(page->head, requirements.alignment) : 0;
+
+	if (!page || offset + requirements.size > page->backing.size) {
+		uint32_t page_ix = 0;
+		for (; page_ix < pool->page_count; page_ix++) {
+			if (pool->pages[page_ix].live_count == 0) break;
+		}
+		if (page_ix == pool->page_count) {
+			Memory_Allocation backing = allocate_buddy(gpu_if, pool, memory_type, EV_MEMORY_PAGE_SIZE);
+			pool->pages = EV_REALLOC(Linear_Page, pool->pages, pool->page_count + 1);
+			pool->pages[pool->page_count].backing = backing;
+			pool->pages[pool->page_count].live_count = 0;
+			pool->page_count++;
+		}
+		pool->current_page = page_ix;
+		page = &pool->pages[page_ix];
+		page->head = 0;
+		offset = 0;
+	}
+
+	page->head = offset + requirements.size;
+	page->live_count++;
+
+	Memory_Allocation allocation = {};
+	allocation.kind = EV_ALLOCATION_LINEAR;
+	allocation.memory = page->backing.memory;
+	allocation.offset = page->backing.offset + offset;
+	allocation.size = requirements.size;
+	allocation.mapped = page->backing.mapped ? page->backing.mapped + offset : NULL;
+	allocation.memory_type = memory_type;
+	allocation.block = pool->current_page;
+	return allocation;
+}
+
+void create_device_allocator(GpuIF gpu_if, Device_Allocator* allocator) {
+	*allocator = {};
+	vkGetPhysicalDeviceMemoryProperties(gpu_if.gpu, &allocator->memory_properties);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu_if.gpu, &properties);
+	VkDeviceSize granularity = properties.limits.bufferImageGranularity;
+	allocator->min_node_size = next_pow2(granularity > EV_MEMORY_MIN_NODE_SIZE ? granularity : EV_MEMORY_MIN_NODE_SIZE);
+	allocator->atom_size = properties.limits.nonCoherentAtomSize;
+	allocator->has_budget = gpu_if.features & EV_FEATURE_MEMORY_BUDGET;
+
+	for (uint32_t x = 0; x < allocator->memory_properties.memoryTypeCount; x++) {
+		uint32_t heap_ix = allocator->memory_properties.memoryTypes[x].heapIndex;
+		VkDeviceSize heap_size = allocator->memory_properties.memoryHeaps[heap_ix].size;
+
+		Memory_Type_Pool* pool = &allocator->pools[x];
+		pool->block_size = EV_MEMORY_BLOCK_SIZE;
+		while (pool->block_size > allocator->min_node_size && pool->block_size * 8 > heap_size) {
+			pool->block_size >>= 1;
+		}
+		pool->level_count = log2_floor(pool->block_size / allocator->min_node_size) + 1;
+	}
+
+	GpuIF allocator_if = gpu_if;
+	allocator_if.allocator = allocator;
+	update_memory_budget(allocator_if);
+}
+
+void destroy_device_allocator(GpuIF gpu_if, Device_Allocator* allocator) {
+	for (uint32_t x = 0; x < allocator->memory_properties.memoryTypeCount; x++) {
+		Memory_Type_Pool* pool = &allocator->pools[x];
+		for (uint32_t y = 0; y < pool->block_count; y++) {
+			free_device_block(gpu_if, x, pool->blocks[y].memory, pool->block_size);
+			EV_FREE(pool->blocks[y].state);
+			EV_FREE(pool->blocks[y].next);
+			EV_FREE(pool->blocks[y].prev);
+			EV_FREE(pool->blocks[y].free_heads);
+		}
+		EV_FREE(pool->blocks);
+		EV_FREE(pool->pages);
+	}
+}
+
+Memory_Allocation allocate_device_memory(GpuIF gpu_if, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, bool linear) {
+	Device_Allocator* allocator = gpu_if.allocator;
+	uint32_t memory_type = find_type_index(allocator, requirements.memoryTypeBits, properties, requirements.size);
+	EV_CHECK(memory_type != UINT32_MAX);
+	Memory_Type_Pool* pool = &allocator->pools[memory_type];
+
+	Memory_Allocation allocation;
+	VkDeviceSize node_size = requirements.size > requirements.alignment ? requirements.size : requirements.alignment;
+	node_size = next_pow2(node_size > allocator->min_node_size ? node_size : allocator->min_node_size);
+	bool is_small = requirements.size <= EV_MEMORY_SMALL_SIZE && requirements.alignment <= EV_MEMORY_SMALL_SIZE;
+	if (linear && is_small && pool->block_size >= EV_MEMORY_PAGE_SIZE) {
+		allocation = allocate_linear(gpu_if, pool, memory_type, requirements);
+	}
+	else if (node_size > pool->block_size) {
+		allocation = allocate_dedicated(gpu_if, memory_type, requirements.size);
+	}
+	else {
+		allocation = allocate_buddy(gpu_if, pool, memory_type, node_size);
+	}
+	track_allocation(allocator, memory_type, allocation.size);
+	return allocation;
+}
+
+void free_device_memory(GpuIF gpu_if, Memory_Allocation allocation) {
+	Memory_Type_Pool* pool = &gpu_if.allocator->pools[allocation.memory_type];
+	if (allocation.kind != EV_ALLOCATION_NONE) untrack_allocation(gpu_if.allocator, allocation.memory_type, allocation.size);
+
+	switch (allocation.kind) {
+		case EV_ALLOCATION_DEDICATED: {
+			free_device_block(gpu_if, allocation.memory_type, allocation.memory, allocation.size);
+			gpu_if.allocator->dedicated_counts[allocation.memory_type]--;
+		} break;
+		case EV_ALLOCATION_BUDDY: {
+			Buddy_Block* block = &pool->blocks[allocation.block];
+			block->used -= allocation.size;
+			buddy_free(block, allocation.node);
+		} break;
+		case EV_ALLOCATION_LINEAR: {
+			Linear_Page* page = &pool->pages[allocation.block];
+			page->live_count--;
+			if (page->live_count == 0) page->head = 0;
+		} break;
+		case EV_ALLOCATION_NONE: break;
+	}
+}
+
+static bool needs_range_sync(Device_Allocator* allocator, Memory_Allocation allocation) {
+	VkMemoryPropertyFlags flags = allocator->memory_properties.memoryTypes[allocation.memory_type].propertyFlags;
+	return allocation.mapped && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+static VkMappedMemoryRange mapped_range(Device_Allocator* allocator, Memory_Allocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+	if (size == VK_WHOLE_SIZE) size = allocation.size - offset;
+	VkDeviceSize begin = allocation.offset + offset;
+	VkDeviceSize end = begin + size;
+
+	VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+	range.memory = allocation.memory;
+	range.offset = begin / allocator->atom_size * allocator->atom_size;
+	range.size = EV_ALIGN_UP(end, allocator->atom_size) - range.offset;
+	if (allocation.kind == EV_ALLOCATION_DEDICATED && range.offset + range.size > allocation.size) {
+		range.size = VK_WHOLE_SIZE;
+	}
+	return range;
+}
+
+void flush_device_memory(GpuIF gpu_if, Memory_Allocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+	if (!needs_range_sync(gpu_if.allocator, allocation)) return;
+	VkMappedMemoryRange range = mapped_range(gpu_if.allocator, allocation, offset, size);
+	EV_CHECK_VKRESULT(vkFlushMappedMemoryRanges(gpu_if.device, 1, &range));
+}
+
+void invalidate_device_memory(GpuIF gpu_if, Memory_Allocation allocation, VkDeviceSize offset, VkDeviceSize size) {
+	if (!needs_range_sync(gpu_if.allocator, allocation)) return;
+	VkMappedMemoryRange range = mapped_range(gpu_if.allocator, allocation, offset, size);
+	EV_CHECK_VKRESULT(vkInvalidateMappedMemoryRanges(gpu_if.device, 1, &range));
+}
+
+void update_memory_budget(GpuIF gpu_if) {
+	Device_Allocator* allocator = gpu_if.allocator;
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+	if (allocator->has_budget) {
+		VkPhysicalDeviceMemoryProperties2 properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+		properties.pNext = &budget;
+		vkGetPhysicalDeviceMemoryProperties2(gpu_if.gpu, &properties);
+	}
+
+	for (uint32_t x = 0; x < allocator->memory_properties.memoryHeapCount; x++) {
+		Memory_Heap_Stats* heap = &allocator->heaps[x];
+		if (allocator->has_budget) {
+			heap->budget = budget.heapBudget[x];
+			heap->usage = budget.heapUsage[x];
+		}
+		else {
+			heap->budget = allocator->memory_properties.memoryHeaps[x].size / 10 * 8;
+			heap->usage = heap->block_bytes;
+		}
+		heap->frame_peak = heap->used_bytes;
+	}
+}
+
+Memory_Type_Stats get_memory_type_stats(GpuIF gpu_if, uint32_t memory_type) {
+	Device_Allocator* allocator = gpu_if.allocator;
+	Memory_Type_Pool* pool = &allocator->pools[memory_type];
+	Memory_Type_Stats stats = {};
+	stats.block_count = pool->block_count;
+	stats.dedicated_count = allocator->dedicated_counts[memory_type];
+	stats.allocation_count = allocator->allocation_counts[memory_type];
+
+	for (uint32_t x = 0; x < pool->block_count; x++) {
+		Buddy_Block* block = &pool->blocks[x];
+		stats.block_bytes += pool->block_size;
+		stats.used_bytes += block->used;
+		for (uint32_t level = 0; level < pool->level_count; level++) {
+			if (block->free_heads[level] == EV_NODE_NONE) continue;
+			VkDeviceSize node_size = pool->block_size >> level;
+			if (node_size > stats.largest_free) stats.largest_free = node_size;
+			break;
+		}
+	}
+
+	VkDeviceSize free_bytes = stats.block_bytes - stats.used_bytes;
+	stats.fragmentation = free_bytes ? 1.0f - (float)stats.largest_free / (float)free_bytes : 0.0f;
+	return stats;
+}
+
+bool write_memory_stats(GpuIF gpu_if, const char* path) {
+	FILE* fptr;
+	EV_FOPEN(fptr, path, "w");
+	if (!fptr) return false;
+
+	Device_Allocator* allocator = gpu_if.allocator;
+	VkPhysicalDeviceMemoryProperties* properties = &allocator->memory_properties;
+	fprintf(fptr, "{\n\t\"budget_extension\": %s,\n\t\"device_allocations\": %u,\n\t\"heaps\": [\n",
+		allocator->has_budget ? "true" : "false", allocator->device_allocation_count);
+	for (uint32_t x = 0; x < properties->memoryHeapCount; x++) {
+		Memory_Heap_Stats* heap = &allocator->heaps[x];
+		fprintf(fptr, "\t\t{ \"index\": %u, \"size\": %llu, \"budget\": %llu, \"usage\": %llu, \"block_bytes\": %llu, \"used_bytes\": %llu, "
+			"\"frame_peak\": %llu, \"peak\": %llu, \"allocations\": %u }%s\n",
+			x, (unsigned long long)properties->memoryHeaps[x].size, (unsigned long long)heap->budget, (unsigned long long)heap->usage,
+			(unsigned long long)heap->block_bytes, (unsigned long long)heap->used_bytes, (unsigned long long)heap->frame_peak,
+			(unsigned long long)heap->peak, heap->allocation_count, x + 1 < properties->memoryHeapCount ? "," : "");
+	}
+	fprintf(fptr, "\t],\n\t\"types\": [\n");
+	for (uint32_t x = 0; x < properties->memoryTypeCount; x++) {
+		Memory_Type_Stats stats = get_memory_type_stats(gpu_if, x);
+		fprintf(fptr, "\t\t{ \"index\": %u, \"heap\": %u, \"flags\": %u, \"blocks\": %u, \"dedicated\": %u, \"allocations\": %u, "
+			"\"block_bytes\": %llu, \"used_bytes\": %llu, \"largest_free\": %llu, \"fragmentation\": %.4f }%s\n",
+			x, properties->memoryTypes[x].heapIndex, properties->memoryTypes[x].propertyFlags, stats.block_count, stats.dedicated_count,
+			stats.allocation_count, (unsigned long long)stats.block_bytes, (unsigned long long)stats.used_bytes,
+			(unsigned long long)stats.largest_free, stats.fragmentation, x + 1 < properties->memoryTypeCount ? "," : "");
+	}
+	fprintf(fptr, "\t]\n}\n");
+	fclose(fptr);
+	return true;
+}
+
+uint32_t trim_device_allocator(GpuIF gpu_if) {
+	Device_Allocator* allocator = gpu_if.allocator;
+	uint32_t freed = 0;
+	for (uint32_t x = 0; x < allocator->memory_properties.memoryTypeCount; x++) {
+		Memory_Type_Pool* pool = &allocator->pools[x];
+		while (pool->block_count > 1 && pool->blocks[pool->block_count - 1].used == 0) {
+			Buddy_Block* block = &pool->blocks[--pool->block_count];
+			free_device_block(gpu_if, x, block->memory, pool->block_size);
+			EV_FREE(block->state);
+			EV_FREE(block->next);
+			EV_FREE(block->prev);
+			EV_FREE(block->free_heads);
+			freed++;
+		}
+	}
+	return freed;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+
+#define EV_MEMORY_BLOCK_SIZE (64ULL * 1024 * 1024)
+#define EV_MEMORY_MIN_NODE_SIZE (4ULL * 1024)
+#define EV_MEMORY_PAGE_SIZE (1024ULL * 1024)
+#define EV_MEMORY_SMALL_SIZE (32ULL * 1024)
+
+struct Buddy_Block
+{
+	VkDeviceMemory memory;
+	uint8_t* mapped;
+	uint8_t* state;
+	uint32_t* next;
+	uint32_t* prev;
+	uint32_t* free_heads;
+	VkDeviceSize used;
+};
+
+struct Linear_Page
+{
+	Memory_Allocation backing;
+	VkDeviceSize head;
+	uint32_t live_count;
+};
+
+struct Memory_Type_Pool
+{
+	Buddy_Block* blocks;
+	uint32_t block_count;
+	Linear_Page* pages;
+	uint32_t page_count;
+	uint32_t current_page;
+	VkDeviceSize block_size;
+	uint32_t level_count;
+};
+
+struct Memory_Heap_Stats
+{
+	VkDeviceSize budget;
+	VkDeviceSize usage;
+	VkDeviceSize block_bytes;
+	VkDeviceSize used_bytes;
+	VkDeviceSize frame_peak;
+	VkDeviceSize peak;
+	uint32_t allocation_count;
+};
+
+struct Memory_Type_Stats
+{
+	VkDeviceSize block_bytes;
+	VkDeviceSize used_bytes;
+	VkDeviceSize largest_free;
+	uint32_t block_count;
+	uint32_t dedicated_count;
+	uint32_t allocation_count;
+	float fragmentation;
+};
+
+struct Device_Allocator
+{
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	Memory_Type_Pool pools[VK_MAX_MEMORY_TYPES];
+	Memory_Heap_Stats heaps[VK_MAX_MEMORY_HEAPS];
+	uint32_t dedicated_counts[VK_MAX_MEMORY_TYPES];
+	uint32_t allocation_counts[VK_MAX_MEMORY_TYPES];
+	bool has_budget;
+	VkDeviceSize min_node_size;
+	VkDeviceSize atom_size;
+	uint32_t device_allocation_count;
+};
+
+void create_device_allocator(GpuIF gpu_if, Device_Allocator* allocator);
+void destroy_device_allocator(GpuIF gpu_if, Device_Allocator* allocator);
+Memory_Allocation allocate_device_memory(GpuIF gpu_if, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, bool linear);
+void free_device_memory(GpuIF gpu_if, Memory_Allocation allocation);
+void flush_device_memory(GpuIF gpu_if, Memory_Allocation allocation, VkDeviceSize offset, VkDeviceSize size);
+void invalidate_device_memory(GpuIF gpu_if, Memory_Allocation allocation, VkDeviceSize offset, VkDeviceSize size);
+void update_memory_budget(GpuIF gpu_if);
+Memory_Type_Stats get_memory_type_stats(GpuIF gpu_if, uint32_t memory_type);
+bool write_memory_stats(GpuIF gpu_if, const char* path);
+uint32_t trim_device_allocator(GpuIF gpu_if);
@@ -0,0 +1,109 @@
+#include "vulkan_mesh.hpp"
+
+Mesh_Pool create_mesh_pool(GpuIF gpu_if, uint32_t vertex_stride, uint32_t vertex_capacity, VkIndexType index_type, uint32_t index_capacity) {
+	Mesh_Pool pool = {};
+	pool.index_type = index_type;
+	pool.index_size = index_type == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+	pool.vertex_stride = vertex_stride;
+	pool.vertex_capacity = vertex_capacity;
+	pool.index_capacity = index_capacity;
+
+	pool.vertices = create_bufferblock(gpu_if, (VkDeviceSize)vertex_stride * vertex_capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	pool.indices = create_bufferblock(gpu_if, (VkDeviceSize)pool.index_size * index_capacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	bind_bufferblock(gpu_if, &pool.vertices, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	bind_bufferblock(gpu_if, &pool.indices, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	return pool;
+}
+
+void destroy_mesh_pool(GpuIF gpu_if, Mesh_Pool* pool) {
+	destroy_bufferblock(gpu_if, pool->vertices);
+	destroy_bufferblock(gpu_if, pool->indices);
+	EV_FREE(pool->meshes);
+}
+
+uint32_t add_mesh(GpuIF gpu_if, Mesh_Pool* pool, Upload_Context* upload, const void* vertices, uint32_t vertex_count, const void* indices, uint32_t index_count) {
+	EV_CHECK(pool->vertex_count + vertex_count <= pool->vertex_capacity && pool->index_count + index_count <= pool->index_capacity);
+
+	if (pool->mesh_count == pool->mesh_capacity) {
+		pool->mesh_capacity = pool->mesh_capacity ? pool->mesh_capacity * 2 : 16;
+		pool->meshes = EV_REALLOC(Mesh, pool->meshes, pool->mesh_capacity);
+	}
+	Mesh* mesh = &pool->meshes[pool->mesh_count];
+	mesh->first_index = pool->index_count;
+	mesh->index_count = index_count;
+	mesh->vertex_offset = (int32_t)pool->vertex_count;
+
+	upload_buffer(gpu_if, upload, pool->vertices, (VkDeviceSize)pool->vertex_stride * pool->vertex_count, vertices, (VkDeviceSize)pool->vertex_stride * vertex_count);
+	upload_buffer(gpu_if, upload, pool->indices, (VkDeviceSize)pool->index_size * pool->index_count, indices, (VkDeviceSize)pool->index_size * index_count);
+	pool->vertex_count += vertex_count;
+	pool->index_count += index_count;
+	return pool->mesh_count++;
+}
+
+BufferBlock create_instance_buffer(GpuIF gpu_if, Upload_Context* upload, const void* instances, uint32_t instance_stride, uint32_t instance_count) {
+	VkDeviceSize size = (VkDeviceSize)instance_stride * instance_count;
+	BufferBlock block = create_bufferblock(gpu_if, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	bind_bufferblock(gpu_if, &block, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	upload_buffer(gpu_if, upload, block, 0, instances, size);
+	return block;
+}
+
+Draw_List create_draw_list(GpuIF gpu_if, uint32_t capacity) {
+	Draw_List list = {};
+	list.capacity = capacity;
+	list.staged = EV_ALLOC(VkDrawIndexedIndirectCommand, capacity);
+
+	VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	list.commands = create_bufferblock(gpu_if, sizeof(VkDrawIndexedIndirectCommand) * capacity, usage);
+	list.count = create_bufferblock(gpu_if, sizeof(uint32_t), usage);
+	bind_bufferblock(gpu_if, &list.commands, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	bind_bufferblock(gpu_if, &list.count, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	return list;
+}
+
+void destroy_draw_list(GpuIF gpu_if, Draw_List* list) {
+	destroy_bufferblock(gpu_if, list->commands);
+	destroy_bufferblock(gpu_if, list->count);
+	EV_FREE(list->staged);
+}
+
+void reset_draw_list(Draw_List* list) {
+	list->draw_count = 0;
+}
+
+void push_mesh_draw(Draw_List* list, Mesh_Pool* pool, uint32_t mesh_ix, uint32_t instance_count, uint32_t first_instance) {
+	EV_CHECK(list->draw_count < list->capacity && mesh_ix < pool->mesh_count);
+	Mesh* mesh = &pool->meshes[mesh_ix];
+	list->staged[list->draw_count++] = { mesh->index_count, instance_count, mesh->first_index, mesh->vertex_offset, first_instance };
+}
+
+void upload_draw_list(GpuIF gpu_if, Draw_List* list, Upload_Context* upload) {
+	if (list->draw_count) {
+		upload_buffer(gpu_if, upload, list->commands, 0, list->staged, sizeof(VkDrawIndexedIndirectCommand) * list->draw_count);
+	}
+	upload_buffer(gpu_if, upload, list->count, 0, &list->draw_count, sizeof(uint32_t));
+}
+
+void bind_mesh_buffers(VkCommandBuffer cmd_buffer, Mesh_Pool* pool, VkBuffer instances) {
+	VkBuffer buffers[] = { pool->vertices.buffer, instances };
+	VkDeviceSize offsets[] = { 0, 0 };
+	vkCmdBindVertexBuffers(cmd_buffer, EV_MESH_VERTEX_BINDING, instances ? 2 : 1, buffers, offsets);
+	vkCmdBindIndexBuffer(cmd_buffer, pool->indices.buffer, 0, pool->index_type);
+}
+
+void record_mesh_draws(GpuIF gpu_if, VkCommandBuffer cmd_buffer, Draw_List* list, uint32_t first, uint32_t count) {
+	EV_CHECK(first + count <= list->draw_count);
+	uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+	if (gpu_if.features & EV_FEATURE_MULTI_DRAW_INDIRECT) {
+		vkCmdDrawIndexedIndirect(cmd_buffer, list->commands.buffer, (VkDeviceSize)stride * first, count, stride);
+		return;
+	}
+	for (uint32_t x = first; x < first + count; x++) {
+		vkCmdDrawIndexedIndirect(cmd_buffer, list->commands.buffer, (VkDeviceSize)stride * x, 1, stride);
+	}
+}
+
+void record_mesh_draws_count(GpuIF gpu_if, VkCommandBuffer cmd_buffer, Draw_List* list) {
+	EV_CHECK(gpu_if.features & EV_FEATURE_DRAW_INDIRECT_COUNT);
+	vkCmdDrawIndexedIndirectCount(cmd_buffer, list->commands.buffer, 0, list->count.buffer, 0, list->capacity, sizeof(VkDrawIndexedIndirectCommand));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_upload.hpp"
+
+#define EV_MESH_VERTEX_BINDING 0
+#define EV_MESH_INSTANCE_BINDING 1
+
+struct Mesh
+{
+	uint32_t first_index;
+	uint32_t index_count;
+	int32_t vertex_offset;
+};
+
+struct Mesh_Pool
+{
+	BufferBlock vertices;
+	BufferBlock indices;
+	VkIndexType index_type;
+	uint32_t index_size;
+	uint32_t vertex_stride;
+	uint32_t vertex_count;
+	uint32_t vertex_capacity;
+	uint32_t index_count;
+	uint32_t index_capacity;
+
+	Mesh* meshes;
+	uint32_t mesh_count;
+	uint32_t mesh_capacity;
+};
+
+struct Draw_List
+{
+	BufferBlock commands;
+	BufferBlock count;
+	VkDrawIndexedIndirectCommand* staged;
+	uint32_t draw_count;
+	uint32_t capacity;
+};
+
+Mesh_Pool create_mesh_pool(GpuIF gpu_if, uint32_t vertex_stride, uint32_t vertex_capacity, VkIndexType index_type, uint32_t index_capacity);
+void destroy_mesh_pool(GpuIF gpu_if, Mesh_Pool* pool);
+uint32_t add_mesh(GpuIF gpu_if, Mesh_Pool* pool, Upload_Context* upload, const void* vertices, uint32_t vertex_count, const void* indices, uint32_t index_count);
+
+BufferBlock create_instance_buffer(GpuIF gpu_if, Upload_Context* upload, const void* instances, uint32_t instance_stride, uint32_t instance_count);
+
+Draw_List create_draw_list(GpuIF gpu_if, uint32_t capacity);
+void destroy_draw_list(GpuIF gpu_if, Draw_List* list);
+void reset_draw_list(Draw_List* list);
+void push_mesh_draw(Draw_List* list, Mesh_Pool* pool, uint32_t mesh_ix, uint32_t instance_count, uint32_t first_instance);
+void upload_draw_list(GpuIF gpu_if, Draw_List* list, Upload_Context* upload);
+
+void bind_mesh_buffers(VkCommandBuffer cmd_buffer, Mesh_Pool* pool, VkBuffer instances);
+void record_mesh_draws(GpuIF gpu_if, VkCommandBuffer cmd_buffer, Draw_List* list, uint32_t first, uint32_t count);
+void record_mesh_draws_count(GpuIF gpu_if, VkCommandBuffer cmd_buffer, Draw_List* list);
@@ -1,38 +1,73 @@
 #include "vulkan_pipeline.hpp"
+#include "vulkan_shader.hpp"
 
-VkShaderModule read_SPIRV(GpuIF gpu_if, const char* filename) {
-	size_t size;
-	FILE* fptr;
-	fopen_s(&fptr, filename, "rb");
-
-	fseek(fptr, 0, SEEK_END);
-	size = ftell(fptr);
-	fseek(fptr, 0, SEEK_SET);
-
-	char* code = EV_ALLOC(char, size);
-	size_t result = fread(code, sizeof(char), size, fptr);
-	fclose(fptr);
+bool is_spirv(const void* code, size_t size) {
+	return size >= sizeof(uint32_t) && size % 4 == 0 && *(const uint32_t*)code == EV_SPIRV_MAGIC;
+}
 
+VkShaderModule try_create_shader_module(GpuIF gpu_if, const void* code, size_t size) {
+	if (!is_spirv(code, size)) return VK_NULL_HANDLE;
 	VkShaderModuleCreateInfo module_create_info = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
 	module_create_info.codeSize = size;
-	module_create_info.pCode = (uint32_t*)code;
+	module_create_info.pCode = (const uint32_t*)code;
 
 	VkShaderModule shader_module;
-	EV_CHECK_VKRESULT(vkCreateShaderModule(gpu_if.device, &module_create_info, NULL, &shader_module));
-	EV_FREE(code);
+	if (vkCreateShaderModule(gpu_if.device, &module_create_info, NULL, &shader_module) != VK_SUCCESS) return VK_NULL_HANDLE;
+	return shader_module;
+}
+
+VkShaderModule create_shader_module(GpuIF gpu_if, const void* code, size_t size) {
+	VkShaderModule shader_module = try_create_shader_module(gpu_if, code, size);
+	EV_CHECK(shader_module != VK_NULL_HANDLE);
+	return shader_module;
+}
+
+VkShaderModule load_shader_module(GpuIF gpu_if, const char* filename) {
+	Mapped_File file;
+	EV_CHECK(map_file(&file, filename));
+	VkShaderModule shader_module = create_shader_module(gpu_if, file.data, file.size);
+	unmap_file(&file);
 	return shader_module;
 }
 
-VkRenderPass create_renderpass(GpuIF gpu_if) {
+void add_vertex_binding(Vertex_Layout* layout, uint32_t stride, VkVertexInputRate rate) {
+	EV_CHECK(layout->binding_count < EV_MAX_VERTEX_BINDINGS);
+	uint32_t binding = layout->binding_count++;
+	layout->bindings[binding] = { binding, stride, rate };
+}
+
+void add_vertex_attribute(Vertex_Layout* layout, VkFormat format, uint32_t offset) {
+	EV_CHECK(layout->binding_count > 0 && layout->attribute_count < EV_MAX_VERTEX_ATTRIBUTES);
+	uint32_t location = layout->attribute_count++;
+	layout->attributes[location] = { location, layout->binding_count - 1, format, offset };
+}
+
+Graphics_State default_graphics_state() {
+	Graphics_State state = {};
+	state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	state.polygon_mode = VK_POLYGON_MODE_FILL;
+	state.cull_mode = VK_CULL_MODE_NONE;
+	state.front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	state.depth_compare = VK_COMPARE_OP_LESS_OR_EQUAL;
+	state.src_color = VK_BLEND_FACTOR_SRC_ALPHA;
+	state.dst_color = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	state.color_op = VK_BLEND_OP_ADD;
+	state.src_alpha = VK_BLEND_FACTOR_ONE;
+	state.dst_alpha = VK_BLEND_FACTOR_ZERO;
+	state.alpha_op = VK_BLEND_OP_ADD;
+	return state;
+}
+
+VkRenderPass create_renderpass(GpuIF gpu_if, VkFormat color_format, VkImageLayout final_layout) {
 	VkAttachmentDescription color_attachment = {};
-    color_attachment.format = VK_FORMAT_B8G8R8A8_UNORM;
+    color_attachment.format = color_format;
     color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
     color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.finalLayout = final_layout;
 
 	VkAttachmentReference color_ref = {};
 	color_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -53,45 +88,62 @@ VkRenderPass create_renderpass(GpuIF gpu_if) {
 	renderpass_create_info.dependencyCount = 0;
 	renderpass_create_info.pDependencies = 0;
 
+	VkSubpassDependency readback_dependency = {};
+	readback_dependency.srcSubpass = 0;
+	readback_dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+	readback_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	readback_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	readback_dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	readback_dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	if (final_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+		renderpass_create_info.dependencyCount = 1;
+		renderpass_create_info.pDependencies = &readback_dependency;
+	}
+
 	VkRenderPass renderpass;
 	EV_CHECK_VKRESULT(vkCreateRenderPass(gpu_if.device, &renderpass_create_info, NULL, &renderpass));
 	return renderpass;
 }
 
-VkPipelineLayout create_pipeline_layout(GpuIF gpu_if) {
+VkPipelineLayout create_pipeline_layout(GpuIF gpu_if, VkDescriptorSetLayout* set_layouts, uint32_t set_layout_count, VkPushConstantRange* push_ranges, uint32_t push_range_count) {
 	VkPipelineLayoutCreateInfo layout_create_info = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-	layout_create_info.setLayoutCount = 0;
-	layout_create_info.pSetLayouts = 0;
-	layout_create_info.pushConstantRangeCount = 0;
-	layout_create_info.pPushConstantRanges = 0;
+	layout_create_info.setLayoutCount = set_layout_count;
+	layout_create_info.pSetLayouts = set_layouts;
+	layout_create_info.pushConstantRangeCount = push_range_count;
+	layout_create_info.pPushConstantRanges = push_ranges;
 
 	VkPipelineLayout layout;
 	EV_CHECK_VKRESULT(vkCreatePipelineLayout(gpu_if.device, &layout_create_info, NULL, &layout));
 	return layout;
 }
 
-VkPipeline create_graphics_pipeline(GpuIF gpu_if, VkPipelineLayout layout, VkRenderPass renderpass, const char* vert_spv_file, const char* frag_spv_file) {
-	VkShaderModule vert_module = read_SPIRV(gpu_if, vert_spv_file);
-	VkShaderModule frag_module = read_SPIRV(gpu_if, frag_spv_file);
+VkPipeline try_build_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const Graphics_State* state, const VkSpecializationInfo* specialization, VkShaderModule vert_module, VkShaderModule frag_module) {
+	Graphics_State fixed_state = state ? *state : default_graphics_state();
 
 	VkPipelineShaderStageCreateInfo vertex_stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
 	vertex_stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
 	vertex_stage.module = vert_module;
 	vertex_stage.pName = "main";
+	vertex_stage.pSpecializationInfo = specialization;
 
 	VkPipelineShaderStageCreateInfo fragment_stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
 	fragment_stage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 	fragment_stage.module = frag_module;
 	fragment_stage.pName = "main";
+	fragment_stage.pSpecializationInfo = specialization;
 
 	VkPipelineVertexInputStateCreateInfo vertex_input_state = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-	vertex_input_state.vertexAttributeDescriptionCount = 0;
-	vertex_input_state.pVertexAttributeDescriptions = 0;
-	vertex_input_state.vertexBindingDescriptionCount = 0;
-	vertex_input_state.pVertexBindingDescriptions = 0;
+	if (vertex_layout) {
+		vertex_input_state.vertexAttributeDescriptionCount = vertex_layout->attribute_count;
+		vertex_input_state.pVertexAttributeDescriptions = vertex_layout->attributes;
+		vertex_input_state.vertexBindingDescriptionCount = vertex_layout->binding_count;
+		vertex_input_state.pVertexBindingDescriptions = vertex_layout->bindings;
+	}
 
 	VkPipelineInputAssemblyStateCreateInfo input_assembly_state = {VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
-	input_assembly_state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	input_assembly_state.topology = fixed_state.topology;
 
 	VkPipelineViewportStateCreateInfo viewport_state = {VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
 	viewport_state.scissorCount = 1;
@@ -103,16 +155,29 @@ VkPipeline create_graphics_pipeline(GpuIF gpu_if, VkPipelineLayout layout, VkRen
 	dynamic_state.pDynamicStates = states;
 
 	VkPipelineRasterizationStateCreateInfo rasterizer = {VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizer.polygonMode = fixed_state.polygon_mode;
 	rasterizer.lineWidth = 1.0F;
-	rasterizer.cullMode = VK_CULL_MODE_NONE;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizer.cullMode = fixed_state.cull_mode;
+	rasterizer.frontFace = fixed_state.front_face;
 
 	VkPipelineMultisampleStateCreateInfo multisample_state = {VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
 	multisample_state.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
 	VkPipelineColorBlendAttachmentState color_attachment_state = {};
 	color_attachment_state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT ;
+	color_attachment_state.blendEnable = fixed_state.blend;
+	color_attachment_state.srcColorBlendFactor = fixed_state.src_color;
+	color_attachment_state.dstColorBlendFactor = fixed_state.dst_color;
+	color_attachment_state.colorBlendOp = fixed_state.color_op;
+	color_attachment_state.srcAlphaBlendFactor = fixed_state.src_alpha;
+	color_attachment_state.dstAlphaBlendFactor = fixed_state.dst_alpha;
+	color_attachment_state.alphaBlendOp = fixed_state.alpha_op;
+
+	VkPipelineDepthStencilStateCreateInfo depth_stencil_state = {VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+	depth_stencil_state.depthTestEnable = fixed_state.depth_test;
+	depth_stencil_state.depthWriteEnable = fixed_state.depth_write;
+	depth_stencil_state.depthCompareOp = fixed_state.depth_compare;
+	depth_stencil_state.maxDepthBounds = 1.0f;
 
 	VkPipelineColorBlendStateCreateInfo color_blend_state = {VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
 	color_blend_state.attachmentCount = 1;
@@ -130,30 +195,66 @@ VkPipeline create_graphics_pipeline(GpuIF gpu_if, VkPipelineLayout layout, VkRen
 	gfx_pipeline_create_info.pViewportState = &viewport_state;
 	gfx_pipeline_create_info.pRasterizationState = &rasterizer;
 	gfx_pipeline_create_info.pMultisampleState = &multisample_state;
-	gfx_pipeline_create_info.pDepthStencilState = NULL;
+	gfx_pipeline_create_info.pDepthStencilState = &depth_stencil_state;
 	gfx_pipeline_create_info.pDynamicState = &dynamic_state;
 	gfx_pipeline_create_info.pColorBlendState = &color_blend_state;
 
+	VkPipelineCreationFeedbackEXT feedback;
+	VkPipelineCreationFeedbackCreateInfoEXT feedback_info;
+	gfx_pipeline_create_info.pNext = chain_pipeline_feedback(gpu_if, cache, &feedback, &feedback_info);
+
 	VkPipeline pipeline;
-	EV_CHECK_VKRESULT(vkCreateGraphicsPipelines(gpu_if.device, NULL, 1, &gfx_pipeline_create_info, NULL, &pipeline));
+	if (vkCreateGraphicsPipelines(gpu_if.device, cache ? cache->cache : VK_NULL_HANDLE, 1, &gfx_pipeline_create_info, NULL, &pipeline) != VK_SUCCESS) return VK_NULL_HANDLE;
+	record_pipeline_feedback(cache, &feedback);
+	return pipeline;
+}
+
+VkPipeline build_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const Graphics_State* state, const VkSpecializationInfo* specialization, VkShaderModule vert_module, VkShaderModule frag_module) {
+	VkPipeline pipeline = try_build_graphics_pipeline(gpu_if, cache, layout, renderpass, vertex_layout, state, specialization, vert_module, frag_module);
+	EV_CHECK(pipeline != VK_NULL_HANDLE);
+	return pipeline;
+}
+
+VkPipeline create_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout, const char* vert_spv_file, const char* frag_spv_file) {
+	VkShaderModule vert_module = load_shader_module(gpu_if, vert_spv_file);
+	VkShaderModule frag_module = load_shader_module(gpu_if, frag_spv_file);
+	VkPipeline pipeline = build_graphics_pipeline(gpu_if, cache, layout, renderpass, vertex_layout, NULL, NULL, vert_module, frag_module);
 	vkDestroyShaderModule(gpu_if.device, vert_module, NULL);
 	vkDestroyShaderModule(gpu_if.device, frag_module, NULL);
 	return pipeline;
 }
 
-VkPipeline create_compute_pipeline(GpuIF gpu_if, VkPipelineLayout layout, const char* comp_spv_file) {
-	VkShaderModule comp_module = read_SPIRV(gpu_if, comp_spv_file);
+VkPipeline try_build_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const VkSpecializationInfo* specialization, VkShaderModule comp_module) {
 	VkPipelineShaderStageCreateInfo stage_create_info = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
 	stage_create_info.module = comp_module;
 	stage_create_info.pName = "main";
+	stage_create_info.pSpecializationInfo = specialization;
 	stage_create_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
 
 	VkComputePipelineCreateInfo comp_pipeline_create_info = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
 	comp_pipeline_create_info.layout = layout;
 	comp_pipeline_create_info.stage = stage_create_info;
 
+	VkPipelineCreationFeedbackEXT feedback;
+	VkPipelineCreationFeedbackCreateInfoEXT feedback_info;
+	comp_pipeline_create_info.pNext = chain_pipeline_feedback(gpu_if, cache, &feedback, &feedback_info);
+
 	VkPipeline pipeline;
-	EV_CHECK_VKRESULT(vkCreateComputePipelines(gpu_if.device, NULL, 1, &comp_pipeline_create_info, NULL, &pipeline));
+	if (vkCreateComputePipelines(gpu_if.device, cache ? cache->cache : VK_NULL_HANDLE, 1, &comp_pipeline_create_info, NULL, &pipeline) != VK_SUCCESS) return VK_NULL_HANDLE;
+	record_pipeline_feedback(cache, &feedback);
+	return pipeline;
+}
+
+VkPipeline build_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const VkSpecializationInfo* specialization, VkShaderModule comp_module) {
+	VkPipeline pipeline = try_build_compute_pipeline(gpu_if, cache, layout, specialization, comp_module);
+	EV_CHECK(pipeline != VK_NULL_HANDLE);
+	return pipeline;
+}
+
+VkPipeline create_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const char* comp_spv_file) {
+	VkShaderModule comp_module = load_shader_module(gpu_if, comp_spv_file);
+	VkPipeline pipeline = build_compute_pipeline(gpu_if, cache, layout, NULL, comp_module);
 	vkDestroyShaderModule(gpu_if.device, comp_module, NULL);
 	return pipeline;
 }
\ No newline at end of file
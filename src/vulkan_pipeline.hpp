@@ -1,10 +1,54 @@
 #pragma once
 
-#include <vulkan/vulkan.h>
+#include "vulkan_dispatch.hpp"
 #include "utils.hpp"
 #include "vulkan_structs.hpp"
+#include "vulkan_pipeline_cache.hpp"
 
-VkPipelineLayout create_pipeline_layout(GpuIF gpu_if);
-VkRenderPass create_renderpass(GpuIF gpu_if);
-VkPipeline create_graphics_pipeline(GpuIF gpu_if, VkPipelineLayout layout, VkRenderPass renderpass, const char* vert_spv_file, const char* frag_spv_file);
-VkPipeline create_compute_pipeline(GpuIF gpu_if, VkPipelineLayout layout, const char* comp_spv_file);
+#define EV_MAX_VERTEX_BINDINGS 4
+#define EV_MAX_VERTEX_ATTRIBUTES 16
+#define EV_SPIRV_MAGIC 0x07230203
+
+struct Vertex_Layout
+{
+	VkVertexInputBindingDescription bindings[EV_MAX_VERTEX_BINDINGS];
+	uint32_t binding_count;
+	VkVertexInputAttributeDescription attributes[EV_MAX_VERTEX_ATTRIBUTES];
+	uint32_t attribute_count;
+};
+
+bool is_spirv(const void* code, size_t size);
+VkShaderModule try_create_shader_module(GpuIF gpu_if, const void* code, size_t size);
+VkShaderModule create_shader_module(GpuIF gpu_if, const void* code, size_t size);
+VkShaderModule load_shader_module(GpuIF gpu_if, const char* filename);
+struct Graphics_State
+{
+	VkPrimitiveTopology topology;
+	VkPolygonMode polygon_mode;
+	VkCullModeFlags cull_mode;
+	VkFrontFace front_face;
+	VkBool32 depth_test;
+	VkBool32 depth_write;
+	VkCompareOp depth_compare;
+	VkBool32 blend;
+	VkBlendFactor src_color;
+	VkBlendFactor dst_color;
+	VkBlendOp color_op;
+	VkBlendFactor src_alpha;
+	VkBlendFactor dst_alpha;
+	VkBlendOp alpha_op;
+};
+
+Graphics_State default_graphics_state();
+void add_vertex_binding(Vertex_Layout* layout, uint32_t stride, VkVertexInputRate rate);
+void add_vertex_attribute(Vertex_Layout* layout, VkFormat format, uint32_t offset);
+VkPipelineLayout create_pipeline_layout(GpuIF gpu_if, VkDescriptorSetLayout* set_layouts, uint32_t set_layout_count, VkPushConstantRange* push_ranges, uint32_t push_range_count);
+VkRenderPass create_renderpass(GpuIF gpu_if, VkFormat color_format, VkImageLayout final_layout);
+VkPipeline try_build_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const Graphics_State* state, const VkSpecializationInfo* specialization, VkShaderModule vert_module, VkShaderModule frag_module);
+VkPipeline build_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const Graphics_State* state, const VkSpecializationInfo* specialization, VkShaderModule vert_module, VkShaderModule frag_module);
+VkPipeline try_build_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const VkSpecializationInfo* specialization, VkShaderModule comp_module);
+VkPipeline build_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const VkSpecializationInfo* specialization, VkShaderModule comp_module);
+VkPipeline create_graphics_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout, const char* vert_spv_file, const char* frag_spv_file);
+VkPipeline create_compute_pipeline(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineLayout layout, const char* comp_spv_file);
@@ -0,0 +1,129 @@
+#include <string.h>
+#include "vulkan_pipeline_cache.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static bool is_cache_compatible(VkPhysicalDeviceProperties* properties, const uint8_t* data, size_t size) {
+	VkPipelineCacheHeaderVersionOne header;
+	if (size < sizeof(header)) return false;
+	memcpy(&header, data, sizeof(header));
+
+	return header.headerSize >= sizeof(header) && header.headerSize <= size &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties->vendorID &&
+		header.deviceID == properties->deviceID &&
+		memcmp(header.pipelineCacheUUID, properties->pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+static uint8_t* read_cache_file(const char* path, size_t* size) {
+	FILE* fptr;
+	EV_FOPEN(fptr, path, "rb");
+	if (!fptr) return NULL;
+
+	fseek(fptr, 0, SEEK_END);
+	long length = ftell(fptr);
+	fseek(fptr, 0, SEEK_SET);
+	if (length <= 0) {
+		fclose(fptr);
+		return NULL;
+	}
+
+	uint8_t* data = EV_ALLOC(uint8_t, length);
+	*size = fread(data, 1, length, fptr);
+	fclose(fptr);
+	if (*size != (size_t)length) {
+		EV_FREE(data);
+		return NULL;
+	}
+	return data;
+}
+
+Pipeline_Cache create_pipeline_cache(GpuIF gpu_if, const char* path) {
+	Pipeline_Cache cache = {};
+	EV_CHECK(strlen(path) + 4 < EV_PIPELINE_CACHE_PATH_SIZE);
+	strcpy(cache.path, path);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu_if.gpu, &properties);
+
+	size_t size = 0;
+	uint8_t* data = read_cache_file(path, &size);
+	if (data && !is_cache_compatible(&properties, data, size)) {
+		EV_FREE(data);
+		data = NULL;
+	}
+
+	VkPipelineCacheCreateInfo cache_create_info = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	cache_create_info.initialDataSize = data ? size : 0;
+	cache_create_info.pInitialData = data;
+	if (vkCreatePipelineCache(gpu_if.device, &cache_create_info, NULL, &cache.cache) != VK_SUCCESS) {
+		cache_create_info.initialDataSize = 0;
+		cache_create_info.pInitialData = NULL;
+		EV_CHECK_VKRESULT(vkCreatePipelineCache(gpu_if.device, &cache_create_info, NULL, &cache.cache));
+	}
+	cache.loaded_size = cache_create_info.initialDataSize;
+	EV_FREE(data);
+	return cache;
+}
+
+bool save_pipeline_cache(GpuIF gpu_if, Pipeline_Cache* cache) {
+	if (cache->pipeline_count == cache->saved_pipeline_count) return true;
+
+	size_t size;
+	EV_CHECK_VKRESULT(vkGetPipelineCacheData(gpu_if.device, cache->cache, &size, NULL));
+
+	uint8_t* data = EV_ALLOC(uint8_t, size);
+	EV_CHECK_VKRESULT(vkGetPipelineCacheData(gpu_if.device, cache->cache, &size, data));
+
+	char tmp_path[EV_PIPELINE_CACHE_PATH_SIZE];
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache->path);
+
+	FILE* fptr;
+	EV_FOPEN(fptr, tmp_path, "wb");
+	if (!fptr) {
+		EV_FREE(data);
+		return false;
+	}
+	bool written = fwrite(data, 1, size, fptr) == size;
+	written = fflush(fptr) == 0 && written;
+	fclose(fptr);
+	EV_FREE(data);
+
+#ifdef _WIN32
+	bool renamed = written && MoveFileExA(tmp_path, cache->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	bool renamed = written && rename(tmp_path, cache->path) == 0;
+#endif
+	if (!renamed) {
+		remove(tmp_path);
+		return false;
+	}
+	cache->saved_pipeline_count = cache->pipeline_count;
+	return true;
+}
+
+void destroy_pipeline_cache(GpuIF gpu_if, Pipeline_Cache* cache) {
+	save_pipeline_cache(gpu_if, cache);
+	vkDestroyPipelineCache(gpu_if.device, cache->cache, NULL);
+}
+
+const void* chain_pipeline_feedback(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineCreationFeedbackEXT* feedback, VkPipelineCreationFeedbackCreateInfoEXT* feedback_info) {
+	*feedback = {};
+	if (!cache || !(gpu_if.features & EV_FEATURE_PIPELINE_CREATION_FEEDBACK)) return NULL;
+
+	*feedback_info = { VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT };
+	feedback_info->pPipelineCreationFeedback = feedback;
+	return feedback_info;
+}
+
+void record_pipeline_feedback(Pipeline_Cache* cache, VkPipelineCreationFeedbackEXT* feedback) {
+	if (!cache) return;
+	cache->pipeline_count++;
+	if (!(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)) return;
+
+	if (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) cache->hits++;
+	else cache->misses++;
+	cache->compile_ns += feedback->duration;
+}
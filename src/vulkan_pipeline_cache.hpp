@@ -0,0 +1,25 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+
+#define EV_PIPELINE_CACHE_PATH_SIZE 260
+
+struct Pipeline_Cache
+{
+	VkPipelineCache cache;
+	char path[EV_PIPELINE_CACHE_PATH_SIZE];
+	size_t loaded_size;
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t pipeline_count;
+	uint32_t saved_pipeline_count;
+	uint64_t compile_ns;
+};
+
+Pipeline_Cache create_pipeline_cache(GpuIF gpu_if, const char* path);
+void destroy_pipeline_cache(GpuIF gpu_if, Pipeline_Cache* cache);
+bool save_pipeline_cache(GpuIF gpu_if, Pipeline_Cache* cache);
+const void* chain_pipeline_feedback(GpuIF gpu_if, Pipeline_Cache* cache, VkPipelineCreationFeedbackEXT* feedback, VkPipelineCreationFeedbackCreateInfoEXT* feedback_info);
+void record_pipeline_feedback(Pipeline_Cache* cache, VkPipelineCreationFeedbackEXT* feedback);
@@ -0,0 +1,282 @@
+#include <string.h>
+#include "vulkan_pipeline_manager.hpp"
+
+Pipeline_Desc graphics_pipeline_desc(VkPipelineLayout layout, VkRenderPass renderpass, Render_Pass_Key pass_key, const char* vert_spv_file, const char* frag_spv_file) {
+	Pipeline_Desc desc = {};
+	desc.shader_files[0] = vert_spv_file;
+	desc.shader_files[1] = frag_spv_file;
+	desc.shader_count = 2;
+	desc.layout = layout;
+	desc.renderpass = renderpass;
+	desc.pass_key = pass_key;
+	desc.state = default_graphics_state();
+	return desc;
+}
+
+Pipeline_Desc compute_pipeline_desc(VkPipelineLayout layout, const char* comp_spv_file) {
+	Pipeline_Desc desc = {};
+	desc.shader_files[0] = comp_spv_file;
+	desc.shader_count = 1;
+	desc.layout = layout;
+	return desc;
+}
+
+void add_specialization(Pipeline_Desc* desc, uint32_t id, uint32_t value) {
+	EV_CHECK(desc->spec_count < EV_MAX_SPECIALIZATION_CONSTANTS);
+	desc->spec_ids[desc->spec_count] = id;
+	desc->spec_values[desc->spec_count++] = value;
+}
+
+static uint64_t hash_desc(const Pipeline_Desc* desc, const uint64_t* module_hashes) {
+	uint64_t hash = hash_bytes(&desc->shader_count, sizeof(desc->shader_count), EV_HASH_SEED);
+	hash = hash_bytes(module_hashes, sizeof(uint64_t) * desc->shader_count, hash);
+	hash = hash_bytes(&desc->layout, sizeof(desc->layout), hash);
+	hash = hash_bytes(desc->spec_ids, sizeof(uint32_t) * desc->spec_count, hash);
+	hash = hash_bytes(desc->spec_values, sizeof(uint32_t) * desc->spec_count, hash);
+	if (desc->shader_count == 1) return hash;
+
+	hash = hash_bytes(&desc->pass_key, sizeof(desc->pass_key), hash);
+	hash = hash_bytes(&desc->state, sizeof(desc->state), hash);
+	hash = hash_bytes(desc->vertex_layout.bindings, sizeof(VkVertexInputBindingDescription) * desc->vertex_layout.binding_count, hash);
+	hash = hash_bytes(desc->vertex_layout.attributes, sizeof(VkVertexInputAttributeDescription) * desc->vertex_layout.attribute_count, hash);
+	return hash;
+}
+
+static VkPipeline build_entry(Pipeline_Manager* manager, Pipeline_Entry* entry, Pipeline_Cache* cache) {
+	Pipeline_Desc* desc = &entry->desc;
+	VkSpecializationMapEntry map_entries[EV_MAX_SPECIALIZATION_CONSTANTS];
+	for (uint32_t x = 0; x < desc->spec_count; x++) {
+		map_entries[x] = { desc->spec_ids[x], x * (uint32_t)sizeof(uint32_t), sizeof(uint32_t) };
+	}
+	VkSpecializationInfo specialization = { desc->spec_count, map_entries, desc->spec_count * sizeof(uint32_t), desc->spec_values };
+	const VkSpecializationInfo* spec_info = desc->spec_count ? &specialization : NULL;
+
+	if (desc->shader_count == 1) {
+		return try_build_compute_pipeline(manager->gpu_if, cache, desc->layout, spec_info, entry->modules[0]);
+	}
+	const Vertex_Layout* vertex_layout = desc->vertex_layout.binding_count ? &desc->vertex_layout : NULL;
+	return try_build_graphics_pipeline(manager->gpu_if, cache, desc->layout, desc->renderpass, vertex_layout, &desc->state, spec_info, entry->modules[0], entry->modules[1]);
+}
+
+static void merge_stats(Pipeline_Cache* dst, Pipeline_Cache* src) {
+	dst->pipeline_count += src->pipeline_count;
+	dst->hits += src->hits;
+	dst->misses += src->misses;
+	dst->compile_ns += src->compile_ns;
+	src->pipeline_count = 0;
+	src->hits = 0;
+	src->misses = 0;
+	src->compile_ns = 0;
+}
+
+static void pipeline_worker_main(Pipeline_Manager* manager) {
+	for (;;) {
+		Pipeline_Entry* entry;
+		{
+			std::unique_lock<std::mutex> lock(manager->mutex);
+			manager->work_cv.wait(lock, [manager] { return manager->quit || manager->queue_count; });
+			if (manager->quit) return;
+			entry = manager->entries[manager->queue[manager->queue_head]];
+			manager->queue_head = (manager->queue_head + 1) % manager->queue_capacity;
+			manager->queue_count--;
+		}
+
+		Pipeline_Cache local = {};
+		if (manager->cache) local.cache = manager->cache->cache;
+		VkPipeline pipeline = build_entry(manager, entry, manager->cache ? &local : NULL);
+		for (uint32_t x = 0; x < entry->desc.shader_count; x++) {
+			release_shader_module(manager->shaders, entry->module_ix[x]);
+		}
+
+		std::lock_guard<std::mutex> lock(manager->mutex);
+		entry->building = false;
+		if (entry->ready.load(std::memory_order_relaxed)) {
+			if (entry->pending) vkDestroyPipeline(manager->gpu_if.device, entry->pending, NULL);
+			entry->pending = pipeline;
+		}
+		else {
+			EV_CHECK(pipeline);
+			entry->pipeline = pipeline;
+			entry->ready.store(true, std::memory_order_release);
+		}
+		merge_stats(&manager->stats, &local);
+		if (--manager->in_flight == 0) manager->done_cv.notify_all();
+	}
+}
+
+Pipeline_Manager* create_pipeline_manager(GpuIF gpu_if, Pipeline_Cache* cache, Shader_Library* shaders, uint32_t worker_count) {
+	EV_CHECK(worker_count > 0);
+	Pipeline_Manager* manager = new Pipeline_Manager();
+	manager->gpu_if = gpu_if;
+	manager->cache = cache;
+	manager->shaders = shaders;
+	manager->worker_count = worker_count;
+	manager->workers = new std::thread[worker_count];
+	for (uint32_t x = 0; x < worker_count; x++) {
+		manager->workers[x] = std::thread(pipeline_worker_main, manager);
+	}
+	return manager;
+}
+
+void destroy_pipeline_manager(Pipeline_Manager* manager) {
+	{
+		std::lock_guard<std::mutex> lock(manager->mutex);
+		manager->quit = true;
+	}
+	manager->work_cv.notify_all();
+	for (uint32_t x = 0; x < manager->worker_count; x++) {
+		manager->workers[x].join();
+	}
+
+	for (uint32_t x = 0; x < manager->entry_count; x++) {
+		Pipeline_Entry* entry = manager->entries[x];
+		if (entry->ready.load(std::memory_order_acquire)) vkDestroyPipeline(manager->gpu_if.device, entry->pipeline, NULL);
+		if (entry->pending) vkDestroyPipeline(manager->gpu_if.device, entry->pending, NULL);
+		if (entry->building) {
+			for (uint32_t y = 0; y < entry->desc.shader_count; y++) {
+				release_shader_module(manager->shaders, entry->module_ix[y]);
+			}
+		}
+		delete entry;
+	}
+	if (manager->cache) merge_stats(manager->cache, &manager->stats);
+	EV_FREE(manager->entries);
+	EV_FREE(manager->queue);
+	delete[] manager->workers;
+	delete manager;
+}
+
+static Pipeline_Handle find_entry(Pipeline_Manager* manager, uint64_t hash) {
+	for (uint32_t x = 0; x < manager->entry_count; x++) {
+		if (manager->entries[x]->hash == hash) return x;
+	}
+	return EV_PIPELINE_HANDLE_NONE;
+}
+
+static void push_job(Pipeline_Manager* manager, Pipeline_Handle handle) {
+	if (manager->queue_count == manager->queue_capacity) {
+		uint32_t capacity = manager->queue_capacity ? manager->queue_capacity * 2 : 16;
+		Pipeline_Handle* queue = EV_ALLOC(Pipeline_Handle, capacity);
+		for (uint32_t x = 0; x < manager->queue_count; x++) {
+			queue[x] = manager->queue[(manager->queue_head + x) % manager->queue_capacity];
+		}
+		EV_FREE(manager->queue);
+		manager->queue = queue;
+		manager->queue_capacity = capacity;
+		manager->queue_head = 0;
+	}
+	manager->queue[(manager->queue_head + manager->queue_count++) % manager->queue_capacity] = handle;
+	manager->entries[handle]->building = true;
+	manager->in_flight++;
+}
+
+void request_pipelines(Pipeline_Manager* manager, const Pipeline_Desc* descs, uint32_t count, Pipeline_Handle fallback, Pipeline_Handle* handles) {
+	std::lock_guard<std::mutex> lock(manager->mutex);
+	for (uint32_t x = 0; x < count; x++) {
+		const Pipeline_Desc* desc = &descs[x];
+		EV_CHECK(desc->shader_count == 1 || desc->shader_count == 2);
+
+		uint32_t module_ix[2];
+		VkShaderModule modules[2];
+		uint64_t module_hashes[2];
+		for (uint32_t y = 0; y < desc->shader_count; y++) {
+			module_ix[y] = acquire_shader_module(manager->shaders, desc->shader_files[y], &modules[y], &module_hashes[y]);
+		}
+
+		uint64_t hash = hash_desc(desc, module_hashes);
+		Pipeline_Handle handle = find_entry(manager, hash);
+		if (handle != EV_PIPELINE_HANDLE_NONE) {
+			for (uint32_t y = 0; y < desc->shader_count; y++) {
+				release_shader_module(manager->shaders, module_ix[y]);
+			}
+			manager->dedup_count++;
+			handles[x] = handle;
+			continue;
+		}
+
+		Pipeline_Entry* entry = new Pipeline_Entry();
+		entry->hash = hash;
+		entry->desc = *desc;
+		entry->fallback = fallback;
+		for (uint32_t y = 0; y < desc->shader_count; y++) {
+			entry->module_ix[y] = module_ix[y];
+			entry->modules[y] = modules[y];
+			entry->module_hashes[y] = module_hashes[y];
+		}
+
+		if (manager->entry_count == manager->entry_capacity) {
+			manager->entry_capacity = manager->entry_capacity ? manager->entry_capacity * 2 : 16;
+			manager->entries = EV_REALLOC(Pipeline_Entry*, manager->entries, manager->entry_capacity);
+		}
+		handle = manager->entry_count++;
+		manager->entries[handle] = entry;
+		push_job(manager, handle);
+		handles[x] = handle;
+	}
+	manager->work_cv.notify_all();
+}
+
+Pipeline_Handle request_pipeline(Pipeline_Manager* manager, const Pipeline_Desc* desc, Pipeline_Handle fallback) {
+	Pipeline_Handle handle;
+	request_pipelines(manager, desc, 1, fallback, &handle);
+	return handle;
+}
+
+bool pipeline_ready(Pipeline_Manager* manager, Pipeline_Handle handle) {
+	std::lock_guard<std::mutex> lock(manager->mutex);
+	return manager->entries[handle]->ready.load(std::memory_order_acquire);
+}
+
+VkPipeline get_pipeline(Pipeline_Manager* manager, Pipeline_Handle handle) {
+	std::lock_guard<std::mutex> lock(manager->mutex);
+	while (handle != EV_PIPELINE_HANDLE_NONE) {
+		Pipeline_Entry* entry = manager->entries[handle];
+		if (entry->ready.load(std::memory_order_acquire)) return entry->pipeline;
+		handle = entry->fallback;
+	}
+	return VK_NULL_HANDLE;
+}
+
+void wait_pipelines(Pipeline_Manager* manager) {
+	std::unique_lock<std::mutex> lock(manager->mutex);
+	manager->done_cv.wait(lock, [manager] { return manager->in_flight == 0; });
+	if (manager->cache) merge_stats(manager->cache, &manager->stats);
+}
+
+static bool entry_shaders_changed(Pipeline_Manager* manager, Pipeline_Entry* entry) {
+	for (uint32_t x = 0; x < entry->desc.shader_count; x++) {
+		if (shader_file_hash(manager->shaders, entry->desc.shader_files[x]) != entry->module_hashes[x]) return true;
+	}
+	return false;
+}
+
+static void requeue_entry(Pipeline_Manager* manager, Pipeline_Handle handle) {
+	Pipeline_Entry* entry = manager->entries[handle];
+	for (uint32_t x = 0; x < entry->desc.shader_count; x++) {
+		entry->module_ix[x] = acquire_shader_module(manager->shaders, entry->desc.shader_files[x], &entry->modules[x], &entry->module_hashes[x]);
+	}
+	entry->hash = hash_desc(&entry->desc, entry->module_hashes);
+	push_job(manager, handle);
+}
+
+uint32_t apply_pipeline_reloads(Pipeline_Manager* manager, Deletion_Queue* deletions) {
+	uint32_t reload_count = shader_reload_count(manager->shaders);
+	std::lock_guard<std::mutex> lock(manager->mutex);
+	uint32_t applied = 0;
+	bool deferred = false;
+	for (uint32_t x = 0; x < manager->entry_count; x++) {
+		Pipeline_Entry* entry = manager->entries[x];
+		if (entry->pending) {
+			defer_destroy_pipeline(deletions, entry->pipeline);
+			entry->pipeline = entry->pending;
+			entry->pending = VK_NULL_HANDLE;
+			applied++;
+		}
+		if (reload_count == manager->reload_count) continue;
+		if (entry->building) deferred = true;
+		else if (entry_shaders_changed(manager, entry)) requeue_entry(manager, x);
+	}
+	if (!deferred) manager->reload_count = reload_count;
+	manager->work_cv.notify_all();
+	return applied;
+}
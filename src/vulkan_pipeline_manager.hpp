@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_pipeline.hpp"
+#include "vulkan_pipeline_cache.hpp"
+#include "vulkan_shader.hpp"
+
+#define EV_MAX_SPECIALIZATION_CONSTANTS 8
+#define EV_PIPELINE_HANDLE_NONE UINT32_MAX
+
+typedef uint32_t Pipeline_Handle;
+
+struct Render_Pass_Key
+{
+	VkFormat color_format;
+	VkFormat depth_format;
+	VkSampleCountFlagBits samples;
+};
+
+struct Pipeline_Desc
+{
+	const char* shader_files[2];
+	uint32_t shader_count;
+	VkPipelineLayout layout;
+	VkRenderPass renderpass;
+	Render_Pass_Key pass_key;
+	Vertex_Layout vertex_layout;
+	Graphics_State state;
+	uint32_t spec_ids[EV_MAX_SPECIALIZATION_CONSTANTS];
+	uint32_t spec_values[EV_MAX_SPECIALIZATION_CONSTANTS];
+	uint32_t spec_count;
+};
+
+struct Pipeline_Entry
+{
+	uint64_t hash;
+	Pipeline_Desc desc;
+	uint32_t module_ix[2];
+	VkShaderModule modules[2];
+	uint64_t module_hashes[2];
+	Pipeline_Handle fallback;
+	VkPipeline pipeline;
+	VkPipeline pending;
+	bool building;
+	std::atomic<bool> ready;
+};
+
+struct Pipeline_Manager
+{
+	GpuIF gpu_if;
+	Pipeline_Cache* cache;
+	Shader_Library* shaders;
+
+	Pipeline_Entry** entries;
+	uint32_t entry_count;
+	uint32_t entry_capacity;
+	uint32_t dedup_count;
+
+	Pipeline_Handle* queue;
+	uint32_t queue_head;
+	uint32_t queue_count;
+	uint32_t queue_capacity;
+	uint32_t in_flight;
+	uint32_t reload_count;
+	Pipeline_Cache stats;
+
+	std::thread* workers;
+	uint32_t worker_count;
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	bool quit;
+};
+
+Pipeline_Desc graphics_pipeline_desc(VkPipelineLayout layout, VkRenderPass renderpass, Render_Pass_Key pass_key, const char* vert_spv_file, const char* frag_spv_file);
+Pipeline_Desc compute_pipeline_desc(VkPipelineLayout layout, const char* comp_spv_file);
+void add_specialization(Pipeline_Desc* desc, uint32_t id, uint32_t value);
+Pipeline_Manager* create_pipeline_manager(GpuIF gpu_if, Pipeline_Cache* cache, Shader_Library* shaders, uint32_t worker_count);
+void destroy_pipeline_manager(Pipeline_Manager* manager);
+void request_pipelines(Pipeline_Manager* manager, const Pipeline_Desc* descs, uint32_t count, Pipeline_Handle fallback, Pipeline_Handle* handles);
+Pipeline_Handle request_pipeline(Pipeline_Manager* manager, const Pipeline_Desc* desc, Pipeline_Handle fallback);
+bool pipeline_ready(Pipeline_Manager* manager, Pipeline_Handle handle);
+VkPipeline get_pipeline(Pipeline_Manager* manager, Pipeline_Handle handle);
+void wait_pipelines(Pipeline_Manager* manager);
+uint32_t apply_pipeline_reloads(Pipeline_Manager* manager, Deletion_Queue* deletions);
@@ -0,0 +1,203 @@
+#include <string.h>
+#include "vulkan_profiler.hpp"
+
+static double profiler_now_us(Profiler* profiler) {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - profiler->epoch).count();
+}
+
+static void push_event(Profiler* profiler, const char* name, Profile_Track track, uint64_t frame_number, double begin_us, double end_us) {
+	Profile_Event* event = &profiler->events[profiler->event_count % profiler->event_capacity];
+	event->name = name;
+	event->track = track;
+	event->frame_number = frame_number;
+	event->begin_us = begin_us;
+	event->end_us = end_us;
+	profiler->event_count++;
+}
+
+static void push_pass_sample(Profiler* profiler, const char* name, float ms) {
+	Pass_Stats* stats = NULL;
+	for (uint32_t x = 0; x < profiler->pass_count && !stats; x++) {
+		if (strcmp(profiler->passes[x].name, name) == 0) stats = &profiler->passes[x];
+	}
+	if (!stats) {
+		if (profiler->pass_count == EV_PROFILER_MAX_PASSES) return;
+		stats = &profiler->passes[profiler->pass_count++];
+		stats->name = name;
+		stats->sample_count = 0;
+		stats->head = 0;
+	}
+	stats->samples[stats->head] = ms;
+	stats->head = (stats->head + 1) % EV_PROFILER_WINDOW;
+	if (stats->sample_count < EV_PROFILER_WINDOW) stats->sample_count++;
+}
+
+Profiler create_profiler(GpuIF gpu_if, uint32_t queue_family, uint32_t frame_count, uint32_t event_capacity) {
+	EV_CHECK(frame_count > 0 && frame_count <= EV_MAX_FRAMES_IN_FLIGHT);
+
+	Profiler profiler = {};
+	profiler.frame_count = frame_count;
+	profiler.event_capacity = event_capacity;
+	profiler.events = EV_ALLOC(Profile_Event, event_capacity);
+	profiler.epoch = std::chrono::steady_clock::now();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu_if.gpu, &properties);
+
+	uint32_t family_count;
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu_if.gpu, &family_count, NULL);
+	VkQueueFamilyProperties* families = EV_ALLOC(VkQueueFamilyProperties, family_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu_if.gpu, &family_count, families);
+	uint32_t valid_bits = queue_family < family_count ? families[queue_family].timestampValidBits : 0;
+	EV_FREE(families);
+
+	profiler.gpu_supported = valid_bits > 0 && properties.limits.timestampPeriod > 0.0f;
+	profiler.timestamp_period_us = properties.limits.timestampPeriod / 1000.0;
+	profiler.timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (1ull << valid_bits) - 1;
+	if (!profiler.gpu_supported) return profiler;
+
+	VkQueryPoolCreateInfo query_pool_create_info = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+	query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_create_info.queryCount = EV_PROFILER_MAX_GPU_SCOPES * 2;
+	for (uint32_t x = 0; x < frame_count; x++) {
+		EV_CHECK_VKRESULT(vkCreateQueryPool(gpu_if.device, &query_pool_create_info, NULL, &profiler.frames[x].query_pool));
+	}
+	return profiler;
+}
+
+void destroy_profiler(GpuIF gpu_if, Profiler* profiler) {
+	if (profiler->gpu_supported) {
+		for (uint32_t x = 0; x < profiler->frame_count; x++) {
+			vkDestroyQueryPool(gpu_if.device, profiler->frames[x].query_pool, NULL);
+		}
+	}
+	EV_FREE(profiler->events);
+}
+
+static void resolve_frame(GpuIF gpu_if, Profiler* profiler, Profiler_Frame* frame) {
+	frame->pending = false;
+	if (frame->scope_count == 0) return;
+
+	uint64_t timestamps[EV_PROFILER_MAX_GPU_SCOPES * 2];
+	VkResult result = vkGetQueryPoolResults(gpu_if.device, frame->query_pool, 0, frame->scope_count * 2,
+		sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) return;
+
+	uint64_t origin = timestamps[0];
+	for (uint32_t x = 0; x < frame->scope_count; x++) {
+		uint64_t begin = (timestamps[x * 2] - origin) & profiler->timestamp_mask;
+		uint64_t end = (timestamps[x * 2 + 1] - origin) & profiler->timestamp_mask;
+		double begin_us = frame->submit_us + begin * profiler->timestamp_period_us;
+		double end_us = frame->submit_us + end * profiler->timestamp_period_us;
+
+		push_event(profiler, frame->scope_names[x], EV_PROFILE_GPU, frame->frame_number, begin_us, end_us);
+		push_pass_sample(profiler, frame->scope_names[x], (float)((end_us - begin_us) / 1000.0));
+	}
+}
+
+void profiler_begin_frame(GpuIF gpu_if, Profiler* profiler, uint32_t frame_ix, uint64_t frame_number, VkCommandBuffer cmd_buffer) {
+	profiler->frame_ix = frame_ix;
+	profiler->frame_number = frame_number;
+	if (!profiler->gpu_supported) return;
+
+	Profiler_Frame* frame = &profiler->frames[frame_ix];
+	if (frame->pending) resolve_frame(gpu_if, profiler, frame);
+
+	frame->scope_count = 0;
+	frame->scope_depth = 0;
+	frame->frame_number = frame_number;
+	vkCmdResetQueryPool(cmd_buffer, frame->query_pool, 0, EV_PROFILER_MAX_GPU_SCOPES * 2);
+}
+
+void profiler_submit_frame(Profiler* profiler) {
+	if (!profiler->gpu_supported) return;
+	Profiler_Frame* frame = &profiler->frames[profiler->frame_ix];
+	EV_CHECK(frame->scope_depth == 0);
+	frame->submit_us = profiler_now_us(profiler);
+	frame->pending = true;
+}
+
+void flush_profiler(GpuIF gpu_if, Profiler* profiler) {
+	if (!profiler->gpu_supported) return;
+	for (;;) {
+		Profiler_Frame* oldest = NULL;
+		for (uint32_t x = 0; x < profiler->frame_count; x++) {
+			Profiler_Frame* frame = &profiler->frames[x];
+			if (frame->pending && (!oldest || frame->frame_number < oldest->frame_number)) oldest = frame;
+		}
+		if (!oldest) return;
+		resolve_frame(gpu_if, profiler, oldest);
+	}
+}
+
+void gpu_scope_begin(Profiler* profiler, VkCommandBuffer cmd_buffer, const char* name) {
+	if (!profiler->gpu_supported) return;
+	Profiler_Frame* frame = &profiler->frames[profiler->frame_ix];
+	EV_CHECK(frame->scope_count < EV_PROFILER_MAX_GPU_SCOPES && frame->scope_depth < EV_PROFILER_MAX_DEPTH);
+
+	uint32_t scope = frame->scope_count++;
+	frame->scope_names[scope] = name;
+	frame->scope_stack[frame->scope_depth++] = scope;
+	vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame->query_pool, scope * 2);
+}
+
+void gpu_scope_end(Profiler* profiler, VkCommandBuffer cmd_buffer) {
+	if (!profiler->gpu_supported) return;
+	Profiler_Frame* frame = &profiler->frames[profiler->frame_ix];
+	EV_CHECK(frame->scope_depth > 0);
+
+	uint32_t scope = frame->scope_stack[--frame->scope_depth];
+	vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame->query_pool, scope * 2 + 1);
+}
+
+void cpu_scope_begin(Profiler* profiler, const char* name) {
+	EV_CHECK(profiler->cpu_depth < EV_PROFILER_MAX_DEPTH);
+	profiler->cpu_names[profiler->cpu_depth] = name;
+	profiler->cpu_begin[profiler->cpu_depth] = profiler_now_us(profiler);
+	profiler->cpu_depth++;
+}
+
+void cpu_scope_end(Profiler* profiler) {
+	EV_CHECK(profiler->cpu_depth > 0);
+	profiler->cpu_depth--;
+	push_event(profiler, profiler->cpu_names[profiler->cpu_depth], EV_PROFILE_CPU, profiler->frame_number,
+		profiler->cpu_begin[profiler->cpu_depth], profiler_now_us(profiler));
+}
+
+static int compare_floats(const void* a, const void* b) {
+	float fa = *(const float*)a;
+	float fb = *(const float*)b;
+	return (fa > fb) - (fa < fb);
+}
+
+bool get_pass_percentiles(Profiler* profiler, const char* name, float* p50_ms, float* p99_ms) {
+	for (uint32_t x = 0; x < profiler->pass_count; x++) {
+		Pass_Stats* stats = &profiler->passes[x];
+		if (strcmp(stats->name, name) != 0 || stats->sample_count == 0) continue;
+
+		float sorted[EV_PROFILER_WINDOW];
+		memcpy(sorted, stats->samples, sizeof(float) * stats->sample_count);
+		qsort(sorted, stats->sample_count, sizeof(float), compare_floats);
+		*p50_ms = sorted[(stats->sample_count - 1) * 50 / 100];
+		*p99_ms = sorted[(stats->sample_count - 1) * 99 / 100];
+		return true;
+	}
+	return false;
+}
+
+bool export_chrome_trace(Profiler* profiler, const char* path) {
+	FILE* fptr;
+	EV_FOPEN(fptr, path, "w");
+	if (!fptr) return false;
+
+	uint64_t first = profiler->event_count > profiler->event_capacity ? profiler->event_count - profiler->event_capacity : 0;
+	fprintf(fptr, "{\"traceEvents\":[\n");
+	for (uint64_t x = first; x < profiler->event_count; x++) {
+		Profile_Event* event = &profiler->events[x % profiler->event_capacity];
+		fprintf(fptr, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+			x == first ? "" : ",\n", event->name, event->track == EV_PROFILE_GPU ? "gpu" : "cpu", (int)event->track,
+			event->begin_us, event->end_us - event->begin_us, (unsigned long long)event->frame_number);
+	}
+	fprintf(fptr, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	return fclose(fptr) == 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_frame.hpp"
+
+#define EV_PROFILER_MAX_GPU_SCOPES 32
+#define EV_PROFILER_MAX_DEPTH 16
+#define EV_PROFILER_MAX_PASSES 32
+#define EV_PROFILER_WINDOW 256
+
+enum Profile_Track
+{
+	EV_PROFILE_CPU,
+	EV_PROFILE_GPU,
+};
+
+struct Profile_Event
+{
+	const char* name;
+	Profile_Track track;
+	uint64_t frame_number;
+	double begin_us;
+	double end_us;
+};
+
+struct Profiler_Frame
+{
+	VkQueryPool query_pool;
+	const char* scope_names[EV_PROFILER_MAX_GPU_SCOPES];
+	uint32_t scope_count;
+	uint32_t scope_stack[EV_PROFILER_MAX_DEPTH];
+	uint32_t scope_depth;
+	uint64_t frame_number;
+	double submit_us;
+	bool pending;
+};
+
+struct Pass_Stats
+{
+	const char* name;
+	float samples[EV_PROFILER_WINDOW];
+	uint32_t sample_count;
+	uint32_t head;
+};
+
+struct Profiler
+{
+	Profiler_Frame frames[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t frame_count;
+	uint32_t frame_ix;
+	bool gpu_supported;
+	double timestamp_period_us;
+	uint64_t timestamp_mask;
+
+	Profile_Event* events;
+	uint32_t event_capacity;
+	uint64_t event_count;
+
+	Pass_Stats passes[EV_PROFILER_MAX_PASSES];
+	uint32_t pass_count;
+
+	const char* cpu_names[EV_PROFILER_MAX_DEPTH];
+	double cpu_begin[EV_PROFILER_MAX_DEPTH];
+	uint32_t cpu_depth;
+	uint64_t frame_number;
+	std::chrono::steady_clock::time_point epoch;
+};
+
+Profiler create_profiler(GpuIF gpu_if, uint32_t queue_family, uint32_t frame_count, uint32_t event_capacity);
+void destroy_profiler(GpuIF gpu_if, Profiler* profiler);
+void profiler_begin_frame(GpuIF gpu_if, Profiler* profiler, uint32_t frame_ix, uint64_t frame_number, VkCommandBuffer cmd_buffer);
+void profiler_submit_frame(Profiler* profiler);
+void flush_profiler(GpuIF gpu_if, Profiler* profiler);
+void gpu_scope_begin(Profiler* profiler, VkCommandBuffer cmd_buffer, const char* name);
+void gpu_scope_end(Profiler* profiler, VkCommandBuffer cmd_buffer);
+void cpu_scope_begin(Profiler* profiler, const char* name);
+void cpu_scope_end(Profiler* profiler);
+bool get_pass_percentiles(Profiler* profiler, const char* name, float* p50_ms, float* p99_ms);
+bool export_chrome_trace(Profiler* profiler, const char* path);
@@ -0,0 +1,87 @@
+#include "vulkan_queue.hpp"
+
+VkBufferMemoryBarrier buffer_ownership_barrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, uint32_t src_family, uint32_t dst_family) {
+	VkBufferMemoryBarrier barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+	barrier.srcQueueFamilyIndex = src_family;
+	barrier.dstQueueFamilyIndex = dst_family;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+	return barrier;
+}
+
+VkImageMemoryBarrier image_ownership_barrier(VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t src_family, uint32_t dst_family) {
+	VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	barrier.oldLayout = old_layout;
+	barrier.newLayout = new_layout;
+	barrier.srcQueueFamilyIndex = src_family;
+	barrier.dstQueueFamilyIndex = dst_family;
+	barrier.image = image;
+	barrier.subresourceRange = range;
+	return barrier;
+}
+
+void release_buffer_ownership(VkCommandBuffer cmd_buffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags src_stages, VkAccessFlags src_access) {
+	if (src_family == dst_family) return;
+	VkBufferMemoryBarrier barrier = buffer_ownership_barrier(buffer, offset, size, src_family, dst_family);
+	barrier.srcAccessMask = src_access;
+	vkCmdPipelineBarrier(cmd_buffer, src_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+}
+
+void acquire_buffer_ownership(VkCommandBuffer cmd_buffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access) {
+	if (src_family == dst_family) return;
+	VkBufferMemoryBarrier barrier = buffer_ownership_barrier(buffer, offset, size, src_family, dst_family);
+	barrier.dstAccessMask = dst_access;
+	vkCmdPipelineBarrier(cmd_buffer, dst_stages, dst_stages, 0, 0, NULL, 1, &barrier, 0, NULL);
+}
+
+void release_image_ownership(VkCommandBuffer cmd_buffer, VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags src_stages, VkAccessFlags src_access) {
+	if (src_family == dst_family) return;
+	VkImageMemoryBarrier barrier = image_ownership_barrier(image, range, old_layout, new_layout, src_family, dst_family);
+	barrier.srcAccessMask = src_access;
+	vkCmdPipelineBarrier(cmd_buffer, src_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+void acquire_image_ownership(VkCommandBuffer cmd_buffer, VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access) {
+	if (src_family == dst_family) return;
+	VkImageMemoryBarrier barrier = image_ownership_barrier(image, range, old_layout, new_layout, src_family, dst_family);
+	barrier.dstAccessMask = dst_access;
+	vkCmdPipelineBarrier(cmd_buffer, dst_stages, dst_stages, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+void submit_queue(VkQueue queue, Queue_Submit submit, VkFence fence) {
+	EV_CHECK(submit.wait_count <= EV_MAX_SUBMIT_WAITS && submit.signal_count <= EV_MAX_SUBMIT_SIGNALS);
+	VkSemaphore semaphores[EV_MAX_SUBMIT_WAITS + EV_MAX_SUBMIT_SIGNALS];
+	uint64_t values[EV_MAX_SUBMIT_WAITS + EV_MAX_SUBMIT_SIGNALS];
+	VkPipelineStageFlags wait_stages[EV_MAX_SUBMIT_WAITS];
+	for (uint32_t x = 0; x < submit.wait_count; x++) {
+		semaphores[x] = submit.waits[x].semaphore;
+		values[x] = submit.waits[x].value;
+		wait_stages[x] = submit.waits[x].stages;
+	}
+	for (uint32_t x = 0; x < submit.signal_count; x++) {
+		semaphores[submit.wait_count + x] = submit.signals[x].semaphore;
+		values[submit.wait_count + x] = submit.signals[x].value;
+	}
+
+	VkTimelineSemaphoreSubmitInfo timeline_info = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+	timeline_info.waitSemaphoreValueCount = submit.wait_count;
+	timeline_info.pWaitSemaphoreValues = values;
+	timeline_info.signalSemaphoreValueCount = submit.signal_count;
+	timeline_info.pSignalSemaphoreValues = values + submit.wait_count;
+
+	VkSubmitInfo submit_info = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submit_info.pNext = &timeline_info;
+	submit_info.commandBufferCount = submit.cmd_buffer_count;
+	submit_info.pCommandBuffers = submit.cmd_buffers;
+	submit_info.waitSemaphoreCount = submit.wait_count;
+	submit_info.pWaitSemaphores = semaphores;
+	submit_info.pWaitDstStageMask = wait_stages;
+	submit_info.signalSemaphoreCount = submit.signal_count;
+	submit_info.pSignalSemaphores = semaphores + submit.wait_count;
+	EV_CHECK_VKRESULT(vkQueueSubmit(queue, 1, &submit_info, fence));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+
+#define EV_MAX_SUBMIT_WAITS 16
+#define EV_MAX_SUBMIT_SIGNALS 8
+
+struct Semaphore_Point
+{
+	VkSemaphore semaphore;
+	uint64_t value;
+	VkPipelineStageFlags stages;
+};
+
+struct Queue_Submit
+{
+	VkCommandBuffer* cmd_buffers;
+	uint32_t cmd_buffer_count;
+	const Semaphore_Point* waits;
+	uint32_t wait_count;
+	const Semaphore_Point* signals;
+	uint32_t signal_count;
+};
+
+VkBufferMemoryBarrier buffer_ownership_barrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, uint32_t src_family, uint32_t dst_family);
+VkImageMemoryBarrier image_ownership_barrier(VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t src_family, uint32_t dst_family);
+void release_buffer_ownership(VkCommandBuffer cmd_buffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags src_stages, VkAccessFlags src_access);
+void acquire_buffer_ownership(VkCommandBuffer cmd_buffer, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access);
+void release_image_ownership(VkCommandBuffer cmd_buffer, VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags src_stages, VkAccessFlags src_access);
+void acquire_image_ownership(VkCommandBuffer cmd_buffer, VkImage image, VkImageSubresourceRange range, VkImageLayout old_layout, VkImageLayout new_layout,
+	uint32_t src_family, uint32_t dst_family, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access);
+void submit_queue(VkQueue queue, Queue_Submit submit, VkFence fence);
@@ -0,0 +1,61 @@
+#include "vulkan_readback.hpp"
+
+Readback_Ring create_readback_ring(GpuIF gpu_if, VkDeviceSize slot_size, uint32_t slot_count) {
+	Readback_Ring ring = {};
+	ring.slot_size = slot_size;
+	ring.slot_count = slot_count;
+	ring.buffers = EV_ALLOC(BufferBlock, slot_count);
+	ring.values = EV_ALLOC(uint64_t, slot_count);
+
+	for (uint32_t x = 0; x < slot_count; x++) {
+		ring.buffers[x] = create_bufferblock(gpu_if, slot_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		ring.values[x] = 0;
+
+		VkMemoryPropertyFlags memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		if (find_memory_index(gpu_if.gpu, ring.buffers[x].requirements.memoryTypeBits, memory_properties) == (uint32_t)-1) {
+			memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		}
+		bind_bufferblock(gpu_if, &ring.buffers[x], memory_properties);
+	}
+	return ring;
+}
+
+void destroy_readback_ring(GpuIF gpu_if, Readback_Ring* ring) {
+	for (uint32_t x = 0; x < ring->slot_count; x++) {
+		destroy_bufferblock(gpu_if, ring->buffers[x]);
+	}
+	EV_FREE(ring->buffers);
+	EV_FREE(ring->values);
+}
+
+void record_image_readback(Readback_Ring* ring, uint32_t slot, VkCommandBuffer cmd_buffer, VkImage image, VkExtent2D extent) {
+	EV_CHECK((VkDeviceSize)extent.width * extent.height * 4 <= ring->slot_size);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { extent.width, extent.height, 1 };
+	vkCmdCopyImageToBuffer(cmd_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ring->buffers[slot].buffer, 1, &region);
+
+	VkBufferMemoryBarrier host_barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+	host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	host_barrier.buffer = ring->buffers[slot].buffer;
+	host_barrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &host_barrier, 0, NULL);
+}
+
+void submit_readback(Readback_Ring* ring, uint32_t slot, Timeline* timeline, uint64_t value) {
+	ring->timeline = timeline;
+	ring->values[slot] = value;
+}
+
+const void* fetch_readback(GpuIF gpu_if, Readback_Ring* ring, uint32_t slot) {
+	if (ring->values[slot] == 0 || !timeline_reached(gpu_if, ring->timeline, ring->values[slot])) return NULL;
+	ring->values[slot] = 0;
+
+	invalidate_device_memory(gpu_if, ring->buffers[slot].allocation, 0, ring->slot_size);
+	return ring->buffers[slot].allocation.mapped;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_timeline.hpp"
+
+struct Readback_Ring
+{
+	BufferBlock* buffers;
+	uint64_t* values;
+	Timeline* timeline;
+	VkDeviceSize slot_size;
+	uint32_t slot_count;
+};
+
+Readback_Ring create_readback_ring(GpuIF gpu_if, VkDeviceSize slot_size, uint32_t slot_count);
+void destroy_readback_ring(GpuIF gpu_if, Readback_Ring* ring);
+void record_image_readback(Readback_Ring* ring, uint32_t slot, VkCommandBuffer cmd_buffer, VkImage image, VkExtent2D extent);
+void submit_readback(Readback_Ring* ring, uint32_t slot, Timeline* timeline, uint64_t value);
+const void* fetch_readback(GpuIF gpu_if, Readback_Ring* ring, uint32_t slot);
@@ -0,0 +1,129 @@
+#include "vulkan_record.hpp"
+#include "vulkan_context.hpp"
+
+static VkCommandBuffer next_secondary(Record_System* system, Record_Worker* worker, uint32_t frame_ix) {
+	uint32_t used = worker->cmd_buffer_used[frame_ix]++;
+	if (used == worker->cmd_buffer_count[frame_ix]) {
+		uint32_t count = used ? used * 2 : 4;
+		VkCommandBufferAllocateInfo allocate_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocate_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocate_info.commandPool = worker->pools[frame_ix];
+		allocate_info.commandBufferCount = count - used;
+
+		worker->cmd_buffers[frame_ix] = EV_REALLOC(VkCommandBuffer, worker->cmd_buffers[frame_ix], count);
+		EV_CHECK_VKRESULT(vkAllocateCommandBuffers(system->gpu_if.device, &allocate_info, worker->cmd_buffers[frame_ix] + used));
+		worker->cmd_buffer_count[frame_ix] = count;
+	}
+	return worker->cmd_buffers[frame_ix][used];
+}
+
+static void record_worker_chunk(Record_System* system, uint32_t worker_ix) {
+	Record_Worker* worker = &system->workers[worker_ix];
+	uint32_t chunk = (system->item_count + system->worker_count - 1) / system->worker_count;
+	uint32_t first = worker_ix * chunk;
+	worker->recorded = VK_NULL_HANDLE;
+	if (first >= system->item_count) return;
+	uint32_t count = first + chunk > system->item_count ? system->item_count - first : chunk;
+
+	VkCommandBuffer cmd_buffer = next_secondary(system, worker, system->frame_ix);
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	begin_info.pInheritanceInfo = &system->inheritance;
+	EV_CHECK_VKRESULT(vkBeginCommandBuffer(cmd_buffer, &begin_info));
+	system->job(cmd_buffer, first, count, system->user_data);
+	EV_CHECK_VKRESULT(vkEndCommandBuffer(cmd_buffer));
+	worker->recorded = cmd_buffer;
+}
+
+static void record_worker_main(Record_System* system, uint32_t worker_ix) {
+	uint64_t seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(system->mutex);
+			system->work_cv.wait(lock, [&] { return system->quit || system->generation != seen; });
+			if (system->quit) return;
+			seen = system->generation;
+		}
+
+		record_worker_chunk(system, worker_ix);
+
+		std::lock_guard<std::mutex> lock(system->mutex);
+		if (--system->pending == 0) system->done_cv.notify_one();
+	}
+}
+
+Record_System* create_record_system(GpuIF gpu_if, uint32_t worker_count, uint32_t frame_count) {
+	EV_CHECK(worker_count > 0 && frame_count <= EV_MAX_FRAMES_IN_FLIGHT);
+
+	Record_System* system = new Record_System();
+	system->gpu_if = gpu_if;
+	system->worker_count = worker_count;
+	system->frame_count = frame_count;
+	system->workers = new Record_Worker[worker_count]();
+	system->secondaries = EV_ALLOC(VkCommandBuffer, worker_count);
+
+	for (uint32_t x = 0; x < worker_count; x++) {
+		Record_Worker* worker = &system->workers[x];
+		for (uint32_t y = 0; y < frame_count; y++) {
+			worker->pools[y] = create_command_pool(gpu_if, gpu_if.queues[EV_QUEUE_GRAPHICS].family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}
+		worker->thread = std::thread(record_worker_main, system, x);
+	}
+	return system;
+}
+
+void destroy_record_system(Record_System* system) {
+	{
+		std::lock_guard<std::mutex> lock(system->mutex);
+		system->quit = true;
+	}
+	system->work_cv.notify_all();
+
+	for (uint32_t x = 0; x < system->worker_count; x++) {
+		Record_Worker* worker = &system->workers[x];
+		worker->thread.join();
+		for (uint32_t y = 0; y < system->frame_count; y++) {
+			vkDestroyCommandPool(system->gpu_if.device, worker->pools[y], NULL);
+			EV_FREE(worker->cmd_buffers[y]);
+		}
+	}
+	delete[] system->workers;
+	EV_FREE(system->secondaries);
+	delete system;
+}
+
+void reset_record_frame(Record_System* system, uint32_t frame_ix) {
+	for (uint32_t x = 0; x < system->worker_count; x++) {
+		Record_Worker* worker = &system->workers[x];
+		EV_CHECK_VKRESULT(vkResetCommandPool(system->gpu_if.device, worker->pools[frame_ix], 0));
+		worker->cmd_buffer_used[frame_ix] = 0;
+	}
+}
+
+void record_parallel(Record_System* system, uint32_t frame_ix, VkCommandBuffer primary, VkRenderPass renderpass, VkFramebuffer framebuffer, uint32_t item_count, Record_Job* job, void* user_data) {
+	if (item_count == 0) return;
+
+	{
+		std::lock_guard<std::mutex> lock(system->mutex);
+		system->job = job;
+		system->user_data = user_data;
+		system->item_count = item_count;
+		system->frame_ix = frame_ix;
+		system->inheritance = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+		system->inheritance.renderPass = renderpass;
+		system->inheritance.subpass = 0;
+		system->inheritance.framebuffer = framebuffer;
+		system->pending = system->worker_count;
+		system->generation++;
+	}
+	system->work_cv.notify_all();
+
+	std::unique_lock<std::mutex> lock(system->mutex);
+	system->done_cv.wait(lock, [&] { return system->pending == 0; });
+
+	uint32_t secondary_count = 0;
+	for (uint32_t x = 0; x < system->worker_count; x++) {
+		if (system->workers[x].recorded) system->secondaries[secondary_count++] = system->workers[x].recorded;
+	}
+	vkCmdExecuteCommands(primary, secondary_count, system->secondaries);
+}
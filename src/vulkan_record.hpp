@@ -0,0 +1,48 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_frame.hpp"
+
+typedef void Record_Job(VkCommandBuffer cmd_buffer, uint32_t first, uint32_t count, void* user_data);
+
+struct Record_Worker
+{
+	VkCommandPool pools[EV_MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer* cmd_buffers[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t cmd_buffer_count[EV_MAX_FRAMES_IN_FLIGHT];
+	uint32_t cmd_buffer_used[EV_MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer recorded;
+	std::thread thread;
+};
+
+struct Record_System
+{
+	GpuIF gpu_if;
+	Record_Worker* workers;
+	VkCommandBuffer* secondaries;
+	uint32_t worker_count;
+	uint32_t frame_count;
+
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	uint64_t generation;
+	uint32_t pending;
+	bool quit;
+
+	Record_Job* job;
+	void* user_data;
+	uint32_t item_count;
+	uint32_t frame_ix;
+	VkCommandBufferInheritanceInfo inheritance;
+};
+
+Record_System* create_record_system(GpuIF gpu_if, uint32_t worker_count, uint32_t frame_count);
+void destroy_record_system(Record_System* system);
+void reset_record_frame(Record_System* system, uint32_t frame_ix);
+void record_parallel(Record_System* system, uint32_t frame_ix, VkCommandBuffer primary, VkRenderPass renderpass, VkFramebuffer framebuffer, uint32_t item_count, Record_Job* job, void* user_data);
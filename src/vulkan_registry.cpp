@@ -0,0 +1,315 @@
+#include "vulkan_registry.hpp"
+
+static void grow_handle_pool(Handle_Pool* slots, uint32_t capacity) {
+	EV_CHECK(capacity - 1 <= EV_HANDLE_INDEX_MASK);
+	slots->generations = EV_REALLOC(uint32_t, slots->generations, capacity);
+	slots->free_slots = EV_REALLOC(uint32_t, slots->free_slots, capacity);
+	for (uint32_t x = slots->capacity; x < capacity; x++) {
+		slots->generations[x] = 1;
+	}
+	slots->capacity = capacity;
+}
+
+static bool handle_pool_full(Handle_Pool* slots) {
+	return slots->free_count == 0 && slots->used == slots->capacity;
+}
+
+static uint32_t next_pool_capacity(Handle_Pool* slots) {
+	uint32_t capacity = slots->capacity ? slots->capacity * 2 : 64;
+	return capacity - 1 > EV_HANDLE_INDEX_MASK ? EV_HANDLE_INDEX_MASK + 1 : capacity;
+}
+
+static uint32_t acquire_handle(Handle_Pool* slots) {
+	uint32_t index = slots->free_count ? slots->free_slots[--slots->free_count] : slots->used++;
+	slots->live_count++;
+	return (slots->generations[index] << EV_HANDLE_INDEX_BITS) | index;
+}
+
+static bool handle_alive(const Handle_Pool* slots, uint32_t handle) {
+	uint32_t index = EV_HANDLE_INDEX(handle);
+	return index < slots->used && slots->generations[index] == handle >> EV_HANDLE_INDEX_BITS;
+}
+
+static uint32_t release_handle(Handle_Pool* slots, uint32_t handle) {
+	EV_CHECK(handle_alive(slots, handle));
+	uint32_t index = EV_HANDLE_INDEX(handle);
+	uint32_t generation = (slots->generations[index] + 1) & EV_HANDLE_GENERATION_MASK;
+	slots->generations[index] = generation ? generation : 1;
+	slots->free_slots[slots->free_count++] = index;
+	slots->live_count--;
+	return index;
+}
+
+static void destroy_handle_pool(Handle_Pool* slots) {
+	EV_FREE(slots->generations);
+	EV_FREE(slots->free_slots);
+}
+
+static void grow_buffer_pool(Buffer_Pool* pool, uint32_t capacity) {
+	grow_handle_pool(&pool->slots, capacity);
+	pool->buffers = EV_REALLOC(VkBuffer, pool->buffers, capacity);
+	pool->sizes = EV_REALLOC(VkDeviceSize, pool->sizes, capacity);
+	pool->usages = EV_REALLOC(VkBufferUsageFlags, pool->usages, capacity);
+	pool->allocations = EV_REALLOC(Memory_Allocation, pool->allocations, capacity);
+	pool->last_used = EV_REALLOC(uint64_t, pool->last_used, capacity);
+}
+
+static void grow_image_pool(Image_Pool* pool, uint32_t capacity) {
+	grow_handle_pool(&pool->slots, capacity);
+	pool->images = EV_REALLOC(VkImage, pool->images, capacity);
+	pool->sizes = EV_REALLOC(VkDeviceSize, pool->sizes, capacity);
+	pool->usages = EV_REALLOC(VkImageUsageFlags, pool->usages, capacity);
+	pool->extents = EV_REALLOC(VkExtent3D, pool->extents, capacity);
+	pool->formats = EV_REALLOC(VkFormat, pool->formats, capacity);
+	pool->allocations = EV_REALLOC(Memory_Allocation, pool->allocations, capacity);
+	pool->last_used = EV_REALLOC(uint64_t, pool->last_used, capacity);
+}
+
+Resource_Registry create_resource_registry(uint32_t buffer_capacity, uint32_t image_capacity) {
+	Resource_Registry registry = {};
+	if (buffer_capacity) grow_buffer_pool(&registry.buffers, buffer_capacity);
+	if (image_capacity) grow_image_pool(&registry.images, image_capacity);
+	return registry;
+}
+
+void destroy_resource_registry(GpuIF gpu_if, Resource_Registry* registry) {
+	Buffer_Pool* buffers = &registry->buffers;
+	for (uint32_t x = 0; x < buffers->slots.used; x++) {
+		if (!buffers->sizes[x]) continue;
+		vkDestroyBuffer(gpu_if.device, buffers->buffers[x], NULL);
+		free_device_memory(gpu_if, buffers->allocations[x]);
+	}
+	destroy_handle_pool(&buffers->slots);
+	EV_FREE(buffers->buffers);
+	EV_FREE(buffers->sizes);
+	EV_FREE(buffers->usages);
+	EV_FREE(buffers->allocations);
+	EV_FREE(buffers->last_used);
+
+	Image_Pool* images = &registry->images;
+	for (uint32_t x = 0; x < images->slots.used; x++) {
+		if (!images->sizes[x]) continue;
+		vkDestroyImage(gpu_if.device, images->images[x], NULL);
+		free_device_memory(gpu_if, images->allocations[x]);
+	}
+	destroy_handle_pool(&images->slots);
+	EV_FREE(images->images);
+	EV_FREE(images->sizes);
+	EV_FREE(images->usages);
+	EV_FREE(images->extents);
+	EV_FREE(images->formats);
+	EV_FREE(images->allocations);
+	EV_FREE(images->last_used);
+	*registry = {};
+}
+
+void begin_registry_frame(Resource_Registry* registry, uint64_t frame) {
+	registry->frame = frame;
+}
+
+Registry_Stats registry_stats(Resource_Registry* registry, uint64_t idle_frames) {
+	Registry_Stats stats = {};
+	uint64_t idle_before = registry->frame > idle_frames ? registry->frame - idle_frames : 0;
+
+	Buffer_Pool* buffers = &registry->buffers;
+	for (uint32_t x = 0; x < buffers->slots.used; x++) {
+		stats.buffer_bytes += buffers->sizes[x];
+		if (buffers->last_used[x] < idle_before) stats.idle_bytes += buffers->sizes[x];
+	}
+	Image_Pool* images = &registry->images;
+	for (uint32_t x = 0; x < images->slots.used; x++) {
+		stats.image_bytes += images->sizes[x];
+		if (images->last_used[x] < idle_before) stats.idle_bytes += images->sizes[x];
+	}
+	stats.buffer_count = buffers->slots.live_count;
+	stats.image_count = images->slots.live_count;
+	return stats;
+}
+
+Buffer_Handle registry_create_buffer(GpuIF gpu_if, Resource_Registry* registry, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+	Buffer_Pool* pool = &registry->buffers;
+	if (handle_pool_full(&pool->slots) && pool->slots.capacity <= EV_HANDLE_INDEX_MASK) grow_buffer_pool(pool, next_pool_capacity(&pool->slots));
+	if (handle_pool_full(&pool->slots)) return { EV_HANDLE_NULL };
+
+	BufferBlock block = create_bufferblock(gpu_if, size, usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	bind_bufferblock(gpu_if, &block, properties);
+
+	uint32_t handle = acquire_handle(&pool->slots);
+	uint32_t ix = EV_HANDLE_INDEX(handle);
+	pool->buffers[ix] = block.buffer;
+	pool->sizes[ix] = size;
+	pool->usages[ix] = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	pool->allocations[ix] = block.allocation;
+	pool->last_used[ix] = registry->frame;
+	return { handle };
+}
+
+static uint32_t release_buffer_slot(Buffer_Pool* pool, Buffer_Handle handle) {
+	uint32_t ix = release_handle(&pool->slots, handle.value);
+	pool->sizes[ix] = 0;
+	pool->last_used[ix] = UINT64_MAX;
+	return ix;
+}
+
+void registry_destroy_buffer(GpuIF gpu_if, Resource_Registry* registry, Buffer_Handle handle) {
+	Buffer_Pool* pool = &registry->buffers;
+	uint32_t ix = release_buffer_slot(pool, handle);
+	vkDestroyBuffer(gpu_if.device, pool->buffers[ix], NULL);
+	free_device_memory(gpu_if, pool->allocations[ix]);
+}
+
+void registry_defer_destroy_buffer(Resource_Registry* registry, Deletion_Queue* deletions, Buffer_Handle handle) {
+	BufferBlock block = registry_buffer_block(registry, handle);
+	release_buffer_slot(&registry->buffers, handle);
+	defer_destroy_buffer(deletions, block);
+}
+
+bool registry_buffer_alive(Resource_Registry* registry, Buffer_Handle handle) {
+	return handle_alive(&registry->buffers.slots, handle.value);
+}
+
+VkBuffer registry_buffer(Resource_Registry* registry, Buffer_Handle handle) {
+	EV_CHECK(registry_buffer_alive(registry, handle));
+	return registry->buffers.buffers[EV_HANDLE_INDEX(handle.value)];
+}
+
+BufferBlock registry_buffer_block(Resource_Registry* registry, Buffer_Handle handle) {
+	EV_CHECK(registry_buffer_alive(registry, handle));
+	uint32_t ix = EV_HANDLE_INDEX(handle.value);
+	BufferBlock block = {};
+	block.buffer = registry->buffers.buffers[ix];
+	block.requirements.size = registry->buffers.sizes[ix];
+	block.allocation = registry->buffers.allocations[ix];
+	return block;
+}
+
+void registry_use_buffer(Resource_Registry* registry, Buffer_Handle handle) {
+	EV_CHECK(registry_buffer_alive(registry, handle));
+	registry->buffers.last_used[EV_HANDLE_INDEX(handle.value)] = registry->frame;
+}
+
+Image_Handle registry_create_image(GpuIF gpu_if, Resource_Registry* registry, Image_Desc desc, VkMemoryPropertyFlags properties) {
+	Image_Pool* pool = &registry->images;
+	if (handle_pool_full(&pool->slots) && pool->slots.capacity <= EV_HANDLE_INDEX_MASK) grow_image_pool(pool, next_pool_capacity(&pool->slots));
+	if (handle_pool_full(&pool->slots)) return { EV_HANDLE_NULL };
+
+	ImageBlock block = create_image(gpu_if, desc);
+	bind_imageblock(gpu_if, &block, properties);
+
+	uint32_t handle = acquire_handle(&pool->slots);
+	uint32_t ix = EV_HANDLE_INDEX(handle);
+	pool->images[ix] = block.image;
+	pool->sizes[ix] = block.requirements.size;
+	pool->usages[ix] = desc.usage;
+	pool->extents[ix] = desc.extent;
+	pool->formats[ix] = desc.format;
+	pool->allocations[ix] = block.allocation;
+	pool->last_used[ix] = registry->frame;
+	return { handle };
+}
+
+static uint32_t release_image_slot(Image_Pool* pool, Image_Handle handle) {
+	uint32_t ix = release_handle(&pool->slots, handle.value);
+	pool->sizes[ix] = 0;
+	pool->last_used[ix] = UINT64_MAX;
+	return ix;
+}
+
+void registry_destroy_image(GpuIF gpu_if, Resource_Registry* registry, Image_Handle handle) {
+	Image_Pool* pool = &registry->images;
+	uint32_t ix = release_image_slot(pool, handle);
+	vkDestroyImage(gpu_if.device, pool->images[ix], NULL);
+	free_device_memory(gpu_if, pool->allocations[ix]);
+}
+
+void registry_defer_destroy_image(Resource_Registry* registry, Deletion_Queue* deletions, Image_Handle handle) {
+	ImageBlock block = registry_image_block(registry, handle);
+	release_image_slot(&registry->images, handle);
+	defer_destroy_image(deletions, block);
+}
+
+bool registry_image_alive(Resource_Registry* registry, Image_Handle handle) {
+	return handle_alive(&registry->images.slots, handle.value);
+}
+
+VkImage registry_image(Resource_Registry* registry, Image_Handle handle) {
+	EV_CHECK(registry_image_alive(registry, handle));
+	return registry->images.images[EV_HANDLE_INDEX(handle.value)];
+}
+
+ImageBlock registry_image_block(Resource_Registry* registry, Image_Handle handle) {
+	EV_CHECK(registry_image_alive(registry, handle));
+	uint32_t ix = EV_HANDLE_INDEX(handle.value);
+	ImageBlock block = {};
+	block.image = registry->images.images[ix];
+	block.requirements.size = registry->images.sizes[ix];
+	block.allocation = registry->images.allocations[ix];
+	return block;
+}
+
+void registry_use_image(Resource_Registry* registry, Image_Handle handle) {
+	EV_CHECK(registry_image_alive(registry, handle));
+	registry->images.last_used[EV_HANDLE_INDEX(handle.value)] = registry->frame;
+}
+
+static void defrag_barrier(VkCommandBuffer cmd_buffer, VkPipelineStageFlags src_stages, VkAccessFlags src_access, VkPipelineStageFlags dst_stages, VkAccessFlags dst_access) {
+	VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+	barrier.srcAccessMask = src_access;
+	barrier.dstAccessMask = dst_access;
+	vkCmdPipelineBarrier(cmd_buffer, src_stages, dst_stages, 0, 1, &barrier, 0, NULL, 0, NULL);
+}
+
+uint32_t registry_defragment(GpuIF gpu_if, Resource_Registry* registry, VkCommandBuffer cmd_buffer, Deletion_Queue* deletions, VkDeviceSize max_bytes,
+	Buffer_Handle* moved, uint32_t moved_capacity) {
+	Device_Allocator* allocator = gpu_if.allocator;
+	Buffer_Pool* pool = &registry->buffers;
+	trim_device_allocator(gpu_if);
+
+	uint32_t stalled_types = 0;
+	uint32_t moved_count = 0;
+	VkDeviceSize moved_bytes = 0;
+	for (uint32_t x = 0; x < pool->slots.used && moved_bytes < max_bytes; x++) {
+		if (moved && moved_count == moved_capacity) break;
+		Memory_Allocation* allocation = &pool->allocations[x];
+		if (!pool->sizes[x] || allocation->kind != EV_ALLOCATION_BUDDY) continue;
+
+		uint32_t memory_type = allocation->memory_type;
+		Memory_Type_Pool* type_pool = &allocator->pools[memory_type];
+		VkMemoryPropertyFlags properties = allocator->memory_properties.memoryTypes[memory_type].propertyFlags;
+		if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) continue;
+		if ((stalled_types >> memory_type) & 1 || type_pool->block_count < 2 || allocation->block + 1 != type_pool->block_count) continue;
+
+		BufferBlock block = create_bufferblock(gpu_if, pool->sizes[x], pool->usages[x]);
+		block.allocation = allocate_device_memory(gpu_if, block.requirements, properties, false);
+		bool is_compacted = block.allocation.kind == EV_ALLOCATION_BUDDY && block.allocation.memory_type == memory_type && block.allocation.block < allocation->block;
+		if (!is_compacted) {
+			destroy_bufferblock(gpu_if, block);
+			stalled_types |= 1u << memory_type;
+			continue;
+		}
+		EV_CHECK_VKRESULT(vkBindBufferMemory(gpu_if.device, block.buffer, block.allocation.memory, block.allocation.offset));
+
+		if (moved_count == 0) {
+			defrag_barrier(cmd_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+		}
+		VkBufferCopy region = { 0, 0, pool->sizes[x] };
+		vkCmdCopyBuffer(cmd_buffer, pool->buffers[x], block.buffer, 1, &region);
+
+		BufferBlock old_block = {};
+		old_block.buffer = pool->buffers[x];
+		old_block.allocation = *allocation;
+		defer_destroy_buffer(deletions, old_block);
+
+		pool->buffers[x] = block.buffer;
+		*allocation = block.allocation;
+		if (moved) moved[moved_count] = { (pool->slots.generations[x] << EV_HANDLE_INDEX_BITS) | x };
+		moved_count++;
+		moved_bytes += pool->sizes[x];
+	}
+
+	if (moved_count) {
+		defrag_barrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+	}
+	return moved_count;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_deletion.hpp"
+
+#define EV_HANDLE_INDEX_BITS 20
+#define EV_HANDLE_INDEX_MASK ((1u << EV_HANDLE_INDEX_BITS) - 1)
+#define EV_HANDLE_GENERATION_MASK ((1u << (32 - EV_HANDLE_INDEX_BITS)) - 1)
+#define EV_HANDLE_NULL 0u
+#define EV_HANDLE_INDEX(h) ((h) & EV_HANDLE_INDEX_MASK)
+
+struct Buffer_Handle
+{
+	uint32_t value;
+};
+
+struct Image_Handle
+{
+	uint32_t value;
+};
+
+struct Handle_Pool
+{
+	uint32_t* generations;
+	uint32_t* free_slots;
+	uint32_t free_count;
+	uint32_t used;
+	uint32_t capacity;
+	uint32_t live_count;
+};
+
+struct Buffer_Pool
+{
+	Handle_Pool slots;
+	VkBuffer* buffers;
+	VkDeviceSize* sizes;
+	VkBufferUsageFlags* usages;
+	Memory_Allocation* allocations;
+	uint64_t* last_used;
+};
+
+struct Image_Pool
+{
+	Handle_Pool slots;
+	VkImage* images;
+	VkDeviceSize* sizes;
+	VkImageUsageFlags* usages;
+	VkExtent3D* extents;
+	VkFormat* formats;
+	Memory_Allocation* allocations;
+	uint64_t* last_used;
+};
+
+struct Resource_Registry
+{
+	Buffer_Pool buffers;
+	Image_Pool images;
+	uint64_t frame;
+};
+
+struct Registry_Stats
+{
+	uint32_t buffer_count;
+	uint32_t image_count;
+	VkDeviceSize buffer_bytes;
+	VkDeviceSize image_bytes;
+	VkDeviceSize idle_bytes;
+};
+
+Resource_Registry create_resource_registry(uint32_t buffer_capacity, uint32_t image_capacity);
+void destroy_resource_registry(GpuIF gpu_if, Resource_Registry* registry);
+void begin_registry_frame(Resource_Registry* registry, uint64_t frame);
+Registry_Stats registry_stats(Resource_Registry* registry, uint64_t idle_frames);
+uint32_t registry_defragment(GpuIF gpu_if, Resource_Registry* registry, VkCommandBuffer cmd_buffer, Deletion_Queue* deletions, VkDeviceSize max_bytes,
+	Buffer_Handle* moved, uint32_t moved_capacity);
+
+Buffer_Handle registry_create_buffer(GpuIF gpu_if, Resource_Registry* registry, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+void registry_destroy_buffer(GpuIF gpu_if, Resource_Registry* registry, Buffer_Handle handle);
+void registry_defer_destroy_buffer(Resource_Registry* registry, Deletion_Queue* deletions, Buffer_Handle handle);
+bool registry_buffer_alive(Resource_Registry* registry, Buffer_Handle handle);
+VkBuffer registry_buffer(Resource_Registry* registry, Buffer_Handle handle);
+BufferBlock registry_buffer_block(Resource_Registry* registry, Buffer_Handle handle);
+void registry_use_buffer(Resource_Registry* registry, Buffer_Handle handle);
+
+Image_Handle registry_create_image(GpuIF gpu_if, Resource_Registry* registry, Image_Desc desc, VkMemoryPropertyFlags properties);
+void registry_destroy_image(GpuIF gpu_if, Resource_Registry* registry, Image_Handle handle);
+void registry_defer_destroy_image(Resource_Registry* registry, Deletion_Queue* deletions, Image_Handle handle);
+bool registry_image_alive(Resource_Registry* registry, Image_Handle handle);
+VkImage registry_image(Resource_Registry* registry, Image_Handle handle);
+ImageBlock registry_image_block(Resource_Registry* registry, Image_Handle handle);
+void registry_use_image(Resource_Registry* registry, Image_Handle handle);
@@ -15,7 +15,7 @@ uint32_t find_memory_index(VkPhysicalDevice gpu, uint32_t required_memory_bits,
 
 		if (is_required_memory_type && has_required_properties) return x;
 	}
-	return -1;
+	return UINT32_MAX;
 }
 
 VkDeviceMemory allocate_memory(GpuIF gpu_if, VkDeviceSize size, uint32_t required_memory_bits, VkMemoryPropertyFlags properties) {
@@ -23,6 +23,7 @@ VkDeviceMemory allocate_memory(GpuIF gpu_if, VkDeviceSize size, uint32_t require
 	allocate_info.allocationSize = size;
 
 	uint32_t ix = find_memory_index(gpu_if.gpu, required_memory_bits, properties);
+	EV_CHECK(ix != UINT32_MAX);
 	allocate_info.memoryTypeIndex = ix;
 
 	VkDeviceMemory memory;
@@ -43,22 +44,27 @@ BufferBlock create_bufferblock(GpuIF gpu_if, VkDeviceSize size, VkBufferUsageFla
 
 	return block;
 }
+void bind_bufferblock(GpuIF gpu_if, BufferBlock* block, VkMemoryPropertyFlags properties) {
+	block->allocation = allocate_device_memory(gpu_if, block->requirements, properties, true);
+	EV_CHECK_VKRESULT(vkBindBufferMemory(gpu_if.device, block->buffer, block->allocation.memory, block->allocation.offset));
+}
 void destroy_bufferblock(GpuIF gpu_if, BufferBlock block) {
 	vkDestroyBuffer(gpu_if.device, block.buffer, NULL);
-	vkFreeMemory(gpu_if.device, block.memory, NULL);
+	free_device_memory(gpu_if, block.allocation);
 }
 
-ImageBlock create_imageblock(GpuIF gpu_if, VkExtent3D extent, VkImageUsageFlags usage) {
+ImageBlock create_image(GpuIF gpu_if, Image_Desc desc) {
 	ImageBlock block = {};
 	VkImageCreateInfo image_create_info = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-    image_create_info.imageType = VK_IMAGE_TYPE_2D;
-    image_create_info.format = VK_FORMAT_B8G8R8A8_UNORM;
-    image_create_info.extent = extent;
-    image_create_info.mipLevels = 1;
-    image_create_info.arrayLayers = 1;
+    image_create_info.flags = desc.flags;
+    image_create_info.imageType = desc.extent.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+    image_create_info.format = desc.format;
+    image_create_info.extent = desc.extent;
+    image_create_info.mipLevels = desc.mip_count ? desc.mip_count : 1;
+    image_create_info.arrayLayers = desc.layer_count ? desc.layer_count : 1;
     image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
     image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    image_create_info.usage = usage;
+    image_create_info.usage = desc.usage;
     image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
@@ -68,7 +74,18 @@ ImageBlock create_imageblock(GpuIF gpu_if, VkExtent3D extent, VkImageUsageFlags
 
 	return block;
 }
+ImageBlock create_imageblock(GpuIF gpu_if, VkExtent3D extent, VkImageUsageFlags usage) {
+	Image_Desc desc = {};
+	desc.extent = extent;
+	desc.format = VK_FORMAT_B8G8R8A8_UNORM;
+	desc.usage = usage;
+	return create_image(gpu_if, desc);
+}
+void bind_imageblock(GpuIF gpu_if, ImageBlock* block, VkMemoryPropertyFlags properties) {
+	block->allocation = allocate_device_memory(gpu_if, block->requirements, properties, false);
+	EV_CHECK_VKRESULT(vkBindImageMemory(gpu_if.device, block->image, block->allocation.memory, block->allocation.offset));
+}
 void destroy_imageblock(GpuIF gpu_if, ImageBlock block) {
 	vkDestroyImage(gpu_if.device, block.image, NULL);
-	vkFreeMemory(gpu_if.device, block.memory, NULL);
+	free_device_memory(gpu_if, block.allocation);
 }
@@ -1,25 +1,40 @@
 #pragma once
 
-#include <vulkan/vulkan.h>
+#include "vulkan_dispatch.hpp"
 #include "utils.hpp"
 #include "vulkan_structs.hpp"
+#include "vulkan_memory.hpp"
 
 struct BufferBlock
 {
 	VkBuffer buffer;
 	VkMemoryRequirements requirements;
-	VkDeviceMemory memory;
+	Memory_Allocation allocation;
+};
+
+struct Image_Desc
+{
+	VkExtent3D extent;
+	VkFormat format;
+	uint32_t mip_count;
+	uint32_t layer_count;
+	VkImageUsageFlags usage;
+	VkImageCreateFlags flags;
 };
 
 struct ImageBlock
 {
 	VkImage image;
 	VkMemoryRequirements requirements;
-	VkDeviceMemory memory;
+	Memory_Allocation allocation;
 };
 
+uint32_t find_memory_index(VkPhysicalDevice gpu, uint32_t required_memory_bits, VkMemoryPropertyFlags required_memory_properties);
 VkDeviceMemory allocate_memory(GpuIF gpu_if, VkDeviceSize size, uint32_t required_memory_bits, VkMemoryPropertyFlags properties);
 BufferBlock create_bufferblock(GpuIF gpu_if, VkDeviceSize size, VkBufferUsageFlags usage);
+void bind_bufferblock(GpuIF gpu_if, BufferBlock* block, VkMemoryPropertyFlags properties);
 void destroy_bufferblock(GpuIF gpu_if, BufferBlock block);
+ImageBlock create_image(GpuIF gpu_if, Image_Desc desc);
 ImageBlock create_imageblock(GpuIF gpu_if, VkExtent3D extent, VkImageUsageFlags usage);
+void bind_imageblock(GpuIF gpu_if, ImageBlock* block, VkMemoryPropertyFlags properties);
 void destroy_imageblock(GpuIF gpu_if, ImageBlock block);
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "vulkan_shader.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+bool map_file(Mapped_File* file, const char* path) {
+	*file = {};
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) {
+		CloseHandle(handle);
+		return false;
+	}
+	file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!file->data) {
+		CloseHandle(mapping);
+		CloseHandle(handle);
+		return false;
+	}
+	file->size = (size_t)size.QuadPart;
+	file->file = handle;
+	file->mapping = mapping;
+	return true;
+}
+
+void unmap_file(Mapped_File* file) {
+	UnmapViewOfFile(file->data);
+	CloseHandle(file->mapping);
+	CloseHandle(file->file);
+}
+#else
+bool map_file(Mapped_File* file, const char* path) {
+	*file = {};
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
+
+	file->data = data;
+	file->size = (size_t)st.st_size;
+	return true;
+}
+
+void unmap_file(Mapped_File* file) {
+	munmap((void*)file->data, file->size);
+}
+#endif
+
+static bool file_stamp(const char* path, int64_t* mtime, int64_t* size) {
+	struct stat st;
+	if (stat(path, &st) != 0) return false;
+#ifdef _WIN32
+	*mtime = (int64_t)st.st_mtime * 1000000000;
+#else
+	*mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+	*size = (int64_t)st.st_size;
+	return true;
+}
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint64_t hash = seed;
+	for (size_t x = 0; x < size; x++) {
+		hash ^= bytes[x];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static uint32_t find_module(Shader_Library* library, uint64_t hash, size_t size) {
+	for (uint32_t x = 0; x < library->module_count; x++) {
+		Shader_Module* module = &library->modules[x];
+		if (module->ref_count && module->hash == hash && module->size == size) return x;
+	}
+	return UINT32_MAX;
+}
+
+static uint32_t insert_module(Shader_Library* library, uint64_t hash, size_t size, VkShaderModule shader_module) {
+	uint32_t module_ix = library->module_count;
+	for (uint32_t x = 0; x < library->module_count; x++) {
+		if (library->modules[x].ref_count == 0) {
+			module_ix = x;
+			break;
+		}
+	}
+	if (module_ix == library->module_count) {
+		if (library->module_count == library->module_capacity) {
+			library->module_capacity = library->module_capacity ? library->module_capacity * 2 : 16;
+			library->modules = EV_REALLOC(Shader_Module, library->modules, library->module_capacity);
+		}
+		library->module_count++;
+	}
+	library->modules[module_ix] = { hash, size, shader_module, 1 };
+	return module_ix;
+}
+
+static void release_module(Shader_Library* library, uint32_t module_ix) {
+	Shader_Module* module = &library->modules[module_ix];
+	if (--module->ref_count == 0) {
+		vkDestroyShaderModule(library->gpu_if.device, module->module, NULL);
+		module->module = VK_NULL_HANDLE;
+	}
+}
+
+static uint32_t acquire_module(Shader_Library* library, const void* code, size_t size) {
+	uint64_t hash = hash_bytes(code, size, EV_HASH_SEED);
+	uint32_t module_ix = find_module(library, hash, size);
+	if (module_ix != UINT32_MAX) {
+		library->modules[module_ix].ref_count++;
+		return module_ix;
+	}
+	return insert_module(library, hash, size, create_shader_module(library->gpu_if, code, size));
+}
+
+static uint32_t acquire_file(Shader_Library* library, const char* path) {
+	for (uint32_t x = 0; x < library->file_count; x++) {
+		if (strcmp(library->files[x].path, path) == 0) return x;
+	}
+	EV_CHECK(strlen(path) < EV_SHADER_PATH_SIZE);
+
+	Mapped_File mapped;
+	EV_CHECK(map_file(&mapped, path));
+	if (library->file_count == library->file_capacity) {
+		library->file_capacity = library->file_capacity ? library->file_capacity * 2 : 16;
+		library->files = EV_REALLOC(Shader_File, library->files, library->file_capacity);
+	}
+	Shader_File* file = &library->files[library->file_count];
+	strcpy(file->path, path);
+	EV_CHECK(file_stamp(path, &file->mtime, &file->size));
+	file->module_ix = acquire_module(library, mapped.data, mapped.size);
+	unmap_file(&mapped);
+	return library->file_count++;
+}
+
+static VkPipeline build_library_pipeline(Shader_Library* library, Pipeline_Cache* cache, Shader_Pipeline* pipeline, VkShaderModule* modules) {
+	if (pipeline->kind == EV_SHADER_PIPELINE_COMPUTE) {
+		return try_build_compute_pipeline(library->gpu_if, cache, pipeline->layout, NULL, modules[0]);
+	}
+	return try_build_graphics_pipeline(library->gpu_if, cache, pipeline->layout, pipeline->renderpass,
+		pipeline->has_vertex_layout ? &pipeline->vertex_layout : NULL, NULL, NULL, modules[0], modules[1]);
+}
+
+static bool pipeline_uses_file(Shader_Pipeline* pipeline, uint32_t file_ix) {
+	for (uint32_t x = 0; x < pipeline->file_count; x++) {
+		if (pipeline->files[x] == file_ix) return true;
+	}
+	return false;
+}
+
+static void reload_pipelines(Shader_Library* library, uint32_t file_ix) {
+	for (uint32_t x = 0;; x++) {
+		Shader_Pipeline* pipeline;
+		VkShaderModule modules[2];
+		{
+			std::lock_guard<std::mutex> lock(library->mutex);
+			if (x >= library->pipeline_count) return;
+			pipeline = library->pipelines[x];
+			if (!pipeline_uses_file(pipeline, file_ix)) continue;
+			for (uint32_t y = 0; y < pipeline->file_count; y++) {
+				modules[y] = library->modules[library->files[pipeline->files[y]].module_ix].module;
+			}
+		}
+
+		VkPipeline rebuilt = build_library_pipeline(library, NULL, pipeline, modules);
+		if (!rebuilt) continue;
+
+		std::lock_guard<std::mutex> lock(library->mutex);
+		if (pipeline->pending) vkDestroyPipeline(library->gpu_if.device, pipeline->pending, NULL);
+		pipeline->pending = rebuilt;
+	}
+}
+
+static void reload_file(Shader_Library* library, uint32_t file_ix, int64_t mtime, int64_t file_size) {
+	char path[EV_SHADER_PATH_SIZE];
+	uint32_t old_module_ix;
+	{
+		std::lock_guard<std::mutex> lock(library->mutex);
+		strcpy(path, library->files[file_ix].path);
+		old_module_ix = library->files[file_ix].module_ix;
+	}
+
+	Mapped_File mapped;
+	if (!map_file(&mapped, path)) return;
+	if (!is_spirv(mapped.data, mapped.size)) {
+		unmap_file(&mapped);
+		return;
+	}
+	uint64_t hash = hash_bytes(mapped.data, mapped.size, EV_HASH_SEED);
+	size_t size = mapped.size;
+	bool unchanged;
+	bool shared;
+	{
+		std::lock_guard<std::mutex> lock(library->mutex);
+		Shader_Module* old_module = &library->modules[old_module_ix];
+		unchanged = old_module->hash == hash && old_module->size == size;
+		shared = find_module(library, hash, size) != UINT32_MAX;
+	}
+	VkShaderModule shader_module = VK_NULL_HANDLE;
+	if (!unchanged && !shared) shader_module = try_create_shader_module(library->gpu_if, mapped.data, size);
+	unmap_file(&mapped);
+	if (!unchanged && !shared && !shader_module) return;
+
+	{
+		std::lock_guard<std::mutex> lock(library->mutex);
+		uint32_t module_ix = unchanged ? old_module_ix : find_module(library, hash, size);
+		if (module_ix == UINT32_MAX && !shader_module) return;
+		library->files[file_ix].mtime = mtime;
+		library->files[file_ix].size = file_size;
+		if (unchanged) return;
+		if (module_ix != UINT32_MAX) {
+			library->modules[module_ix].ref_count++;
+			if (shader_module) vkDestroyShaderModule(library->gpu_if.device, shader_module, NULL);
+		}
+		else {
+			module_ix = insert_module(library, hash, size, shader_module);
+		}
+		library->files[file_ix].module_ix = module_ix;
+		release_module(library, old_module_ix);
+		library->reload_count++;
+	}
+	reload_pipelines(library, file_ix);
+}
+
+static void shader_watcher_main(Shader_Library* library) {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(library->mutex);
+			library->quit_cv.wait_for(lock, std::chrono::milliseconds(EV_SHADER_POLL_MS), [library] { return library->quit; });
+			if (library->quit) return;
+		}
+
+		for (uint32_t x = 0;; x++) {
+			char path[EV_SHADER_PATH_SIZE];
+			int64_t mtime;
+			int64_t size;
+			{
+				std::lock_guard<std::mutex> lock(library->mutex);
+				if (x >= library->file_count) break;
+				strcpy(path, library->files[x].path);
+				mtime = library->files[x].mtime;
+				size = library->files[x].size;
+			}
+			int64_t current_mtime;
+			int64_t current_size;
+			if (!file_stamp(path, &current_mtime, &current_size)) continue;
+			if (current_mtime != mtime || current_size != size) reload_file(library, x, current_mtime, current_size);
+		}
+	}
+}
+
+Shader_Library* create_shader_library(GpuIF gpu_if, Pipeline_Cache* cache, bool hot_reload) {
+	Shader_Library* library = new Shader_Library();
+	library->gpu_if = gpu_if;
+	library->cache = cache;
+	if (hot_reload) library->watcher = std::thread(shader_watcher_main, library);
+	return library;
+}
+
+void destroy_shader_library(Shader_Library* library) {
+	{
+		std::lock_guard<std::mutex> lock(library->mutex);
+		library->quit = true;
+	}
+	library->quit_cv.notify_all();
+	if (library->watcher.joinable()) library->watcher.join();
+
+	for (uint32_t x = 0; x < library->pipeline_count; x++) {
+		Shader_Pipeline* pipeline = library->pipelines[x];
+		vkDestroyPipeline(library->gpu_if.device, pipeline->pipeline, NULL);
+		if (pipeline->pending) vkDestroyPipeline(library->gpu_if.device, pipeline->pending, NULL);
+		EV_FREE(pipeline);
+	}
+	for (uint32_t x = 0; x < library->module_count; x++) {
+		if (library->modules[x].ref_count) vkDestroyShaderModule(library->gpu_if.device, library->modules[x].module, NULL);
+	}
+	EV_FREE(library->pipelines);
+	EV_FREE(library->modules);
+	EV_FREE(library->files);
+	delete library;
+}
+
+static Shader_Pipeline* add_pipeline(Shader_Library* library, Shader_Pipeline_Kind kind, VkPipelineLayout layout, const char** spv_files, uint32_t file_count) {
+	Shader_Pipeline* pipeline = EV_ALLOC(Shader_Pipeline, 1);
+	*pipeline = {};
+	pipeline->kind = kind;
+	pipeline->layout = layout;
+	pipeline->file_count = file_count;
+	for (uint32_t x = 0; x < file_count; x++) {
+		pipeline->files[x] = acquire_file(library, spv_files[x]);
+	}
+
+	if (library->pipeline_count == library->pipeline_capacity) {
+		library->pipeline_capacity = library->pipeline_capacity ? library->pipeline_capacity * 2 : 16;
+		library->pipelines = EV_REALLOC(Shader_Pipeline*, library->pipelines, library->pipeline_capacity);
+	}
+	library->pipelines[library->pipeline_count++] = pipeline;
+	return pipeline;
+}
+
+static void build_initial_pipeline(Shader_Library* library, Shader_Pipeline* pipeline) {
+	VkShaderModule modules[2];
+	for (uint32_t x = 0; x < pipeline->file_count; x++) {
+		modules[x] = library->modules[library->files[pipeline->files[x]].module_ix].module;
+	}
+	pipeline->pipeline = build_library_pipeline(library, library->cache, pipeline, modules);
+}
+
+Shader_Pipeline* create_library_graphics_pipeline(Shader_Library* library, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const char* vert_spv_file, const char* frag_spv_file) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	const char* spv_files[] = { vert_spv_file, frag_spv_file };
+	Shader_Pipeline* pipeline = add_pipeline(library, EV_SHADER_PIPELINE_GRAPHICS, layout, spv_files, 2);
+	pipeline->renderpass = renderpass;
+	if (vertex_layout) {
+		pipeline->vertex_layout = *vertex_layout;
+		pipeline->has_vertex_layout = true;
+	}
+	build_initial_pipeline(library, pipeline);
+	return pipeline;
+}
+
+Shader_Pipeline* create_library_compute_pipeline(Shader_Library* library, VkPipelineLayout layout, const char* comp_spv_file) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	Shader_Pipeline* pipeline = add_pipeline(library, EV_SHADER_PIPELINE_COMPUTE, layout, &comp_spv_file, 1);
+	build_initial_pipeline(library, pipeline);
+	return pipeline;
+}
+
+uint32_t acquire_shader_module(Shader_Library* library, const char* spv_file, VkShaderModule* shader_module, uint64_t* hash) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	uint32_t file_ix = acquire_file(library, spv_file);
+	uint32_t module_ix = library->files[file_ix].module_ix;
+	Shader_Module* module = &library->modules[module_ix];
+	module->ref_count++;
+	*shader_module = module->module;
+	*hash = module->hash;
+	return module_ix;
+}
+
+void release_shader_module(Shader_Library* library, uint32_t module_ix) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	release_module(library, module_ix);
+}
+
+uint64_t shader_file_hash(Shader_Library* library, const char* spv_file) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	uint32_t file_ix = acquire_file(library, spv_file);
+	return library->modules[library->files[file_ix].module_ix].hash;
+}
+
+uint32_t shader_reload_count(Shader_Library* library) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	return library->reload_count;
+}
+
+uint32_t apply_shader_reloads(Shader_Library* library, Deletion_Queue* deletions) {
+	std::lock_guard<std::mutex> lock(library->mutex);
+	uint32_t applied = 0;
+	for (uint32_t x = 0; x < library->pipeline_count; x++) {
+		Shader_Pipeline* pipeline = library->pipelines[x];
+		if (!pipeline->pending) continue;
+		defer_destroy_pipeline(deletions, pipeline->pipeline);
+		pipeline->pipeline = pipeline->pending;
+		pipeline->pending = VK_NULL_HANDLE;
+		applied++;
+	}
+	return applied;
+}
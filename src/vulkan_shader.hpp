@@ -0,0 +1,93 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_pipeline.hpp"
+#include "vulkan_deletion.hpp"
+
+#define EV_SHADER_PATH_SIZE 260
+#define EV_SHADER_POLL_MS 250
+#define EV_HASH_SEED 14695981039346656037ULL
+
+struct Mapped_File
+{
+	const void* data;
+	size_t size;
+	void* file;
+	void* mapping;
+};
+
+struct Shader_Module
+{
+	uint64_t hash;
+	size_t size;
+	VkShaderModule module;
+	uint32_t ref_count;
+};
+
+struct Shader_File
+{
+	char path[EV_SHADER_PATH_SIZE];
+	int64_t mtime;
+	int64_t size;
+	uint32_t module_ix;
+};
+
+enum Shader_Pipeline_Kind
+{
+	EV_SHADER_PIPELINE_GRAPHICS,
+	EV_SHADER_PIPELINE_COMPUTE,
+};
+
+struct Shader_Pipeline
+{
+	Shader_Pipeline_Kind kind;
+	uint32_t files[2];
+	uint32_t file_count;
+	VkPipelineLayout layout;
+	VkRenderPass renderpass;
+	Vertex_Layout vertex_layout;
+	bool has_vertex_layout;
+	VkPipeline pipeline;
+	VkPipeline pending;
+};
+
+struct Shader_Library
+{
+	GpuIF gpu_if;
+	Pipeline_Cache* cache;
+
+	Shader_Module* modules;
+	uint32_t module_count;
+	uint32_t module_capacity;
+	Shader_File* files;
+	uint32_t file_count;
+	uint32_t file_capacity;
+	Shader_Pipeline** pipelines;
+	uint32_t pipeline_count;
+	uint32_t pipeline_capacity;
+	uint32_t reload_count;
+
+	std::mutex mutex;
+	std::condition_variable quit_cv;
+	std::thread watcher;
+	bool quit;
+};
+
+bool map_file(Mapped_File* file, const char* path);
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed);
+void unmap_file(Mapped_File* file);
+Shader_Library* create_shader_library(GpuIF gpu_if, Pipeline_Cache* cache, bool hot_reload);
+void destroy_shader_library(Shader_Library* library);
+Shader_Pipeline* create_library_graphics_pipeline(Shader_Library* library, VkPipelineLayout layout, VkRenderPass renderpass, const Vertex_Layout* vertex_layout,
+	const char* vert_spv_file, const char* frag_spv_file);
+Shader_Pipeline* create_library_compute_pipeline(Shader_Library* library, VkPipelineLayout layout, const char* comp_spv_file);
+uint32_t acquire_shader_module(Shader_Library* library, const char* spv_file, VkShaderModule* shader_module, uint64_t* hash);
+void release_shader_module(Shader_Library* library, uint32_t module_ix);
+uint64_t shader_file_hash(Shader_Library* library, const char* spv_file);
+uint32_t shader_reload_count(Shader_Library* library);
+uint32_t apply_shader_reloads(Shader_Library* library, Deletion_Queue* deletions);
@@ -1,5 +1,25 @@
 #pragma once
-#include <vulkan/vulkan.h>
+#include "vulkan_dispatch.hpp"
+
+enum Allocation_Kind
+{
+	EV_ALLOCATION_NONE,
+	EV_ALLOCATION_DEDICATED,
+	EV_ALLOCATION_BUDDY,
+	EV_ALLOCATION_LINEAR,
+};
+
+struct Memory_Allocation
+{
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	uint8_t* mapped;
+	uint32_t memory_type;
+	uint32_t block;
+	uint32_t node;
+	Allocation_Kind kind;
+};
 
 struct Present_Structure
 {
@@ -9,13 +29,45 @@ struct Present_Structure
 	VkFramebuffer* framebuffers;
 	uint32_t image_count;
 	VkSurfaceFormatKHR format;
+	VkPresentModeKHR present_mode;
 	VkExtent2D extent;
+	VkImageUsageFlags usage;
+	Memory_Allocation* allocations;
+};
+
+struct Device_Allocator;
+
+enum Device_Feature
+{
+	EV_FEATURE_PIPELINE_CREATION_FEEDBACK = 1 << 0,
+	EV_FEATURE_DESCRIPTOR_INDEXING = 1 << 1,
+	EV_FEATURE_MULTI_DRAW_INDIRECT = 1 << 2,
+	EV_FEATURE_DRAW_INDIRECT_COUNT = 1 << 3,
+	EV_FEATURE_MEMORY_BUDGET = 1 << 4,
+	EV_FEATURE_TEXTURE_COMPRESSION_BC = 1 << 5,
+};
+
+enum Queue_Kind
+{
+	EV_QUEUE_GRAPHICS,
+	EV_QUEUE_COMPUTE,
+	EV_QUEUE_TRANSFER,
+	EV_QUEUE_KIND_COUNT
+};
+
+struct Queue_Info
+{
+	VkQueue queue;
+	uint32_t family;
 };
 
 struct GpuIF
 {
 	VkPhysicalDevice gpu;
 	VkDevice device;
+	Device_Allocator* allocator;
+	uint32_t features;
+	Queue_Info queues[EV_QUEUE_KIND_COUNT];
 };
 
 struct VK_CTX
@@ -24,4 +76,5 @@ struct VK_CTX
 	GpuIF gpu_if;
 	VkSurfaceKHR surface;
 	Present_Structure present;
+	bool headless;
 };
@@ -0,0 +1,407 @@
+#include <string.h>
+#include "vulkan_texture.hpp"
+#include "vulkan_shader.hpp"
+
+#define EV_DDS_MAGIC 0x20534444
+#define EV_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+struct Format_Info
+{
+	uint32_t block_size;
+	uint32_t block_dim;
+};
+
+struct Ktx2_Header
+{
+	uint8_t identifier[12];
+	uint32_t format;
+	uint32_t type_size;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t layer_count;
+	uint32_t face_count;
+	uint32_t level_count;
+	uint32_t supercompression;
+	uint32_t dfd_offset;
+	uint32_t dfd_size;
+	uint32_t kvd_offset;
+	uint32_t kvd_size;
+	uint64_t sgd_offset;
+	uint64_t sgd_size;
+};
+
+struct Ktx2_Level
+{
+	uint64_t offset;
+	uint64_t size;
+	uint64_t uncompressed_size;
+};
+
+struct Dds_Pixel_Format
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourcc;
+	uint32_t bit_count;
+	uint32_t masks[4];
+};
+
+struct Dds_Header
+{
+	uint32_t magic;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitch;
+	uint32_t depth;
+	uint32_t mip_count;
+	uint32_t reserved[11];
+	Dds_Pixel_Format pixel_format;
+	uint32_t caps[4];
+	uint32_t reserved2;
+};
+
+struct Dds_Dx10_Header
+{
+	uint32_t dxgi_format;
+	uint32_t dimension;
+	uint32_t misc_flags;
+	uint32_t array_size;
+	uint32_t misc_flags2;
+};
+
+static const uint8_t ktx2_identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+static Format_Info format_info(VkFormat format) {
+	switch (format) {
+	case VK_FORMAT_R8_UNORM: return { 1, 1 };
+	case VK_FORMAT_R8G8_UNORM: return { 2, 1 };
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_R32_SFLOAT: return { 4, 1 };
+	case VK_FORMAT_R16G16B16A16_SFLOAT: return { 8, 1 };
+	case VK_FORMAT_R32G32B32A32_SFLOAT: return { 16, 1 };
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+	case VK_FORMAT_BC4_SNORM_BLOCK: return { 8, 4 };
+	case VK_FORMAT_BC2_UNORM_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC5_SNORM_BLOCK:
+	case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+	case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK: return { 16, 4 };
+	default: return { 0, 0 };
+	}
+}
+
+static VkFormat dxgi_to_vk_format(uint32_t dxgi_format) {
+	switch (dxgi_format) {
+	case 2: return VK_FORMAT_R32G32B32A32_SFLOAT;
+	case 10: return VK_FORMAT_R16G16B16A16_SFLOAT;
+	case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+	case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+	case 41: return VK_FORMAT_R32_SFLOAT;
+	case 49: return VK_FORMAT_R8G8_UNORM;
+	case 61: return VK_FORMAT_R8_UNORM;
+	case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+	case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+	case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+	case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+	case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+	case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+	case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+	case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+	case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+	case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+	case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+	case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+	case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+	case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+	default: return VK_FORMAT_UNDEFINED;
+	}
+}
+
+static VkFormat dds_legacy_format(const Dds_Pixel_Format* pixel_format) {
+	switch (pixel_format->fourcc) {
+	case EV_FOURCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	case EV_FOURCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+	case EV_FOURCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+	case EV_FOURCC('A', 'T', 'I', '1'):
+	case EV_FOURCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+	case EV_FOURCC('A', 'T', 'I', '2'):
+	case EV_FOURCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+	case 0:
+		if (pixel_format->bit_count != 32) return VK_FORMAT_UNDEFINED;
+		if (pixel_format->masks[0] == 0x000000FF) return VK_FORMAT_R8G8B8A8_UNORM;
+		if (pixel_format->masks[0] == 0x00FF0000) return VK_FORMAT_B8G8R8A8_UNORM;
+		return VK_FORMAT_UNDEFINED;
+	default: return VK_FORMAT_UNDEFINED;
+	}
+}
+
+bool is_block_compressed(VkFormat format) {
+	return format_info(format).block_dim == 4;
+}
+
+bool texture_format_supported(GpuIF gpu_if, VkFormat format) {
+	if (!format_info(format).block_size) return false;
+	if (is_block_compressed(format) && !(gpu_if.features & EV_FEATURE_TEXTURE_COMPRESSION_BC)) return false;
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(gpu_if.gpu, format, &properties);
+	return properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+}
+
+uint32_t texture_mip_count(VkExtent2D extent) {
+	uint32_t size = extent.width > extent.height ? extent.width : extent.height;
+	uint32_t count = 1;
+	while (size > 1) {
+		size >>= 1;
+		count++;
+	}
+	return count;
+}
+
+VkExtent2D texture_level_extent(VkExtent2D extent, uint32_t level) {
+	uint32_t width = extent.width >> level;
+	uint32_t height = extent.height >> level;
+	return { width ? width : 1, height ? height : 1 };
+}
+
+VkDeviceSize texture_level_size(VkFormat format, VkExtent2D extent, uint32_t level) {
+	Format_Info info = format_info(format);
+	EV_CHECK(info.block_size);
+	VkExtent2D level_extent = texture_level_extent(extent, level);
+	VkDeviceSize blocks_x = (level_extent.width + info.block_dim - 1) / info.block_dim;
+	VkDeviceSize blocks_y = (level_extent.height + info.block_dim - 1) / info.block_dim;
+	return blocks_x * blocks_y * info.block_size;
+}
+
+Texture create_texture(GpuIF gpu_if, Texture_Desc desc) {
+	EV_CHECK(texture_format_supported(gpu_if, desc.format) && (!desc.cube || desc.layer_count % 6 == 0));
+	Texture texture = {};
+	texture.format = desc.format;
+	texture.extent = desc.extent;
+	texture.mip_count = desc.mip_count ? desc.mip_count : texture_mip_count(desc.extent);
+	texture.layer_count = desc.layer_count ? desc.layer_count : 1;
+	texture.cube = desc.cube;
+	texture.pending_mips = desc.generate_mips && texture.mip_count > 1;
+	EV_CHECK(texture.mip_count <= EV_TEXTURE_MAX_MIPS);
+
+	Image_Desc image_desc = {};
+	image_desc.extent = { desc.extent.width, desc.extent.height, 1 };
+	image_desc.format = desc.format;
+	image_desc.mip_count = texture.mip_count;
+	image_desc.layer_count = texture.layer_count;
+	image_desc.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	image_desc.flags = desc.cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+	if (texture.pending_mips) {
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(gpu_if.gpu, desc.format, &properties);
+		VkFormatFeatureFlags blit_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		EV_CHECK(!is_block_compressed(desc.format) && (properties.optimalTilingFeatures & blit_features) == blit_features);
+		image_desc.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+	texture.block = create_image(gpu_if, image_desc);
+	bind_imageblock(gpu_if, &texture.block, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	VkImageViewCreateInfo view_create_info = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+	view_create_info.image = texture.block.image;
+	if (desc.cube) view_create_info.viewType = texture.layer_count > 6 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+	else view_create_info.viewType = texture.layer_count > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+	view_create_info.format = desc.format;
+	view_create_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.mip_count, 0, texture.layer_count };
+	EV_CHECK_VKRESULT(vkCreateImageView(gpu_if.device, &view_create_info, NULL, &texture.view));
+	return texture;
+}
+
+void destroy_texture(GpuIF gpu_if, Texture* texture) {
+	vkDestroyImageView(gpu_if.device, texture->view, NULL);
+	destroy_imageblock(gpu_if, texture->block);
+}
+
+void* stage_texture_level(GpuIF gpu_if, Upload_Context* upload, Texture* texture, uint32_t level, uint32_t first_layer, uint32_t layer_count) {
+	EV_CHECK(level < texture->mip_count && first_layer + layer_count <= texture->layer_count);
+	EV_CHECK(!texture->pending_mips || level == 0);
+	VkExtent2D extent = texture_level_extent(texture->extent, level);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, first_layer, layer_count };
+	region.imageExtent = { extent.width, extent.height, 1 };
+	VkImageLayout final_layout = texture->pending_mips ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	return stage_image_upload(gpu_if, upload, texture->block.image, region, texture_level_size(texture->format, texture->extent, level) * layer_count, final_layout);
+}
+
+void record_texture_mips(VkCommandBuffer cmd_buffer, Texture* texture) {
+	EV_CHECK(texture->pending_mips);
+	VkImageMemoryBarrier barriers[2];
+	barriers[0] = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+	barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].image = texture->block.image;
+	barriers[1] = barriers[0];
+
+	barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, texture->layer_count };
+	barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 1, texture->mip_count - 1, 0, texture->layer_count };
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 2, barriers);
+
+	for (uint32_t level = 1; level < texture->mip_count; level++) {
+		VkExtent2D src_extent = texture_level_extent(texture->extent, level - 1);
+		VkExtent2D dst_extent = texture_level_extent(texture->extent, level);
+		VkImageBlit blit = {};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, texture->layer_count };
+		blit.srcOffsets[1] = { (int32_t)src_extent.width, (int32_t)src_extent.height, 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, texture->layer_count };
+		blit.dstOffsets[1] = { (int32_t)dst_extent.width, (int32_t)dst_extent.height, 1 };
+		vkCmdBlitImage(cmd_buffer, texture->block.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture->block.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, texture->layer_count };
+		vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, barriers);
+	}
+
+	barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture->mip_count, 0, texture->layer_count };
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, barriers);
+	texture->pending_mips = false;
+}
+
+static bool load_ktx2(GpuIF gpu_if, Upload_Context* upload, const uint8_t* data, size_t size, Texture* texture) {
+	if (size < sizeof(Ktx2_Header)) return false;
+	const Ktx2_Header* header = (const Ktx2_Header*)data;
+	if (header->supercompression != 0 || header->depth > 1 || (header->face_count != 1 && header->face_count != 6)) return false;
+	if (!texture_format_supported(gpu_if, (VkFormat)header->format)) return false;
+	if (header->width == 0 || header->layer_count > UINT32_MAX / 6) return false;
+
+	Texture_Desc desc = {};
+	desc.format = (VkFormat)header->format;
+	desc.extent = { header->width, header->height ? header->height : 1 };
+	desc.mip_count = header->level_count;
+	desc.layer_count = (header->layer_count ? header->layer_count : 1) * header->face_count;
+	desc.cube = header->face_count == 6;
+	desc.generate_mips = header->level_count == 0;
+	if (desc.generate_mips && is_block_compressed(desc.format)) desc.mip_count = 1;
+
+	uint32_t max_mips = texture_mip_count(desc.extent);
+	if (max_mips > EV_TEXTURE_MAX_MIPS || desc.mip_count > max_mips) return false;
+	uint32_t file_levels = header->level_count ? header->level_count : 1;
+	if (sizeof(Ktx2_Level) * file_levels > size - sizeof(Ktx2_Header)) return false;
+	const Ktx2_Level* levels = (const Ktx2_Level*)(data + sizeof(Ktx2_Header));
+
+	for (uint32_t x = 0; x < file_levels; x++) {
+		VkDeviceSize level_size = texture_level_size(desc.format, desc.extent, x);
+		if (levels[x].offset > size || levels[x].size > size - levels[x].offset) return false;
+		if (level_size > levels[x].size / desc.layer_count || levels[x].size != level_size * desc.layer_count) return false;
+	}
+
+	*texture = create_texture(gpu_if, desc);
+	for (uint32_t x = 0; x < file_levels; x++) {
+		void* staging = stage_texture_level(gpu_if, upload, texture, x, 0, texture->layer_count);
+		memcpy(staging, data + levels[x].offset, levels[x].size);
+	}
+	return true;
+}
+
+static bool load_dds(GpuIF gpu_if, Upload_Context* upload, const uint8_t* data, size_t size, Texture* texture) {
+	if (size < sizeof(Dds_Header)) return false;
+	const Dds_Header* header = (const Dds_Header*)data;
+	if (header->depth > 1) return false;
+	size_t offset = sizeof(Dds_Header);
+
+	Texture_Desc desc = {};
+	desc.extent = { header->width, header->height };
+	desc.mip_count = header->mip_count ? header->mip_count : 1;
+	desc.layer_count = 1;
+	desc.cube = header->caps[1] & 0x200;
+	if (header->pixel_format.fourcc == EV_FOURCC('D', 'X', '1', '0')) {
+		if (size < offset + sizeof(Dds_Dx10_Header)) return false;
+		const Dds_Dx10_Header* dx10 = (const Dds_Dx10_Header*)(data + offset);
+		offset += sizeof(Dds_Dx10_Header);
+		desc.format = dxgi_to_vk_format(dx10->dxgi_format);
+		desc.layer_count = dx10->array_size ? dx10->array_size : 1;
+		desc.cube = dx10->misc_flags & 0x4;
+	}
+	else {
+		desc.format = dds_legacy_format(&header->pixel_format);
+	}
+	if (!texture_format_supported(gpu_if, desc.format)) return false;
+	if (desc.extent.width == 0 || desc.extent.height == 0) return false;
+	if (desc.cube && desc.layer_count > UINT32_MAX / 6) return false;
+	if (desc.cube) desc.layer_count *= 6;
+
+	uint32_t max_mips = texture_mip_count(desc.extent);
+	if (max_mips > EV_TEXTURE_MAX_MIPS || desc.mip_count > max_mips) return false;
+	size_t total = 0;
+	for (uint32_t x = 0; x < desc.mip_count; x++) {
+		total += texture_level_size(desc.format, desc.extent, x);
+	}
+	if (offset > size || total > (size - offset) / desc.layer_count) return false;
+
+	*texture = create_texture(gpu_if, desc);
+	for (uint32_t layer = 0; layer < desc.layer_count; layer++) {
+		for (uint32_t level = 0; level < desc.mip_count; level++) {
+			VkDeviceSize level_size = texture_level_size(desc.format, desc.extent, level);
+			void* staging = stage_texture_level(gpu_if, upload, texture, level, layer, 1);
+			memcpy(staging, data + offset, level_size);
+			offset += level_size;
+		}
+	}
+	return true;
+}
+
+bool load_texture(GpuIF gpu_if, Upload_Context* upload, const char* filename, Texture* texture) {
+	Mapped_File file;
+	if (!map_file(&file, filename)) return false;
+
+	const uint8_t* data = (const uint8_t*)file.data;
+	bool loaded = false;
+	if (file.size >= sizeof(ktx2_identifier) && memcmp(data, ktx2_identifier, sizeof(ktx2_identifier)) == 0) {
+		loaded = load_ktx2(gpu_if, upload, data, file.size, texture);
+	}
+	else if (file.size >= sizeof(uint32_t) && *(const uint32_t*)data == EV_DDS_MAGIC) {
+		loaded = load_dds(gpu_if, upload, data, file.size, texture);
+	}
+	unmap_file(&file);
+	return loaded;
+}
+
+VkSampler create_texture_sampler(GpuIF gpu_if, VkFilter filter, VkSamplerAddressMode address_mode, uint32_t mip_count) {
+	VkSamplerCreateInfo sampler_create_info = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+	sampler_create_info.magFilter = filter;
+	sampler_create_info.minFilter = filter;
+	sampler_create_info.mipmapMode = filter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	sampler_create_info.addressModeU = address_mode;
+	sampler_create_info.addressModeV = address_mode;
+	sampler_create_info.addressModeW = address_mode;
+	sampler_create_info.maxLod = (float)mip_count;
+
+	VkSampler sampler;
+	EV_CHECK_VKRESULT(vkCreateSampler(gpu_if.device, &sampler_create_info, NULL, &sampler));
+	return sampler;
+}
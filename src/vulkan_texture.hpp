@@ -0,0 +1,44 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_upload.hpp"
+
+#define EV_TEXTURE_MAX_MIPS 16
+
+struct Texture_Desc
+{
+	VkFormat format;
+	VkExtent2D extent;
+	uint32_t mip_count;
+	uint32_t layer_count;
+	bool cube;
+	bool generate_mips;
+};
+
+struct Texture
+{
+	ImageBlock block;
+	VkImageView view;
+	VkFormat format;
+	VkExtent2D extent;
+	uint32_t mip_count;
+	uint32_t layer_count;
+	bool cube;
+	bool pending_mips;
+};
+
+bool is_block_compressed(VkFormat format);
+bool texture_format_supported(GpuIF gpu_if, VkFormat format);
+uint32_t texture_mip_count(VkExtent2D extent);
+VkExtent2D texture_level_extent(VkExtent2D extent, uint32_t level);
+VkDeviceSize texture_level_size(VkFormat format, VkExtent2D extent, uint32_t level);
+
+Texture create_texture(GpuIF gpu_if, Texture_Desc desc);
+void destroy_texture(GpuIF gpu_if, Texture* texture);
+void* stage_texture_level(GpuIF gpu_if, Upload_Context* upload, Texture* texture, uint32_t level, uint32_t first_layer, uint32_t layer_count);
+void record_texture_mips(VkCommandBuffer cmd_buffer, Texture* texture);
+bool load_texture(GpuIF gpu_if, Upload_Context* upload, const char* filename, Texture* texture);
+VkSampler create_texture_sampler(GpuIF gpu_if, VkFilter filter, VkSamplerAddressMode address_mode, uint32_t mip_count);
@@ -0,0 +1,45 @@
+#include "vulkan_timeline.hpp"
+
+Timeline create_timeline(GpuIF gpu_if) {
+	Timeline timeline = {};
+
+	VkSemaphoreTypeCreateInfo type_create_info = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+	type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	type_create_info.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphore_create_info = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	semaphore_create_info.pNext = &type_create_info;
+	EV_CHECK_VKRESULT(vkCreateSemaphore(gpu_if.device, &semaphore_create_info, NULL, &timeline.semaphore));
+	return timeline;
+}
+
+void destroy_timeline(GpuIF gpu_if, Timeline* timeline) {
+	vkDestroySemaphore(gpu_if.device, timeline->semaphore, NULL);
+}
+
+uint64_t timeline_advance(Timeline* timeline) {
+	return ++timeline->value;
+}
+
+Semaphore_Point timeline_point(Timeline* timeline, uint64_t value, VkPipelineStageFlags stages) {
+	return { timeline->semaphore, value, stages };
+}
+
+uint64_t timeline_completed(GpuIF gpu_if, Timeline* timeline) {
+	uint64_t value;
+	EV_CHECK_VKRESULT(vkGetSemaphoreCounterValue(gpu_if.device, timeline->semaphore, &value));
+	return value;
+}
+
+bool timeline_reached(GpuIF gpu_if, Timeline* timeline, uint64_t value) {
+	return value == 0 || timeline_completed(gpu_if, timeline) >= value;
+}
+
+void timeline_wait(GpuIF gpu_if, Timeline* timeline, uint64_t value) {
+	if (value == 0) return;
+	VkSemaphoreWaitInfo wait_info = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores = &timeline->semaphore;
+	wait_info.pValues = &value;
+	EV_CHECK_VKRESULT(vkWaitSemaphores(gpu_if.device, &wait_info, UINT64_MAX));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_queue.hpp"
+
+struct Timeline
+{
+	VkSemaphore semaphore;
+	uint64_t value;
+};
+
+Timeline create_timeline(GpuIF gpu_if);
+void destroy_timeline(GpuIF gpu_if, Timeline* timeline);
+uint64_t timeline_advance(Timeline* timeline);
+Semaphore_Point timeline_point(Timeline* timeline, uint64_t value, VkPipelineStageFlags stages);
+uint64_t timeline_completed(GpuIF gpu_if, Timeline* timeline);
+bool timeline_reached(GpuIF gpu_if, Timeline* timeline, uint64_t value);
+void timeline_wait(GpuIF gpu_if, Timeline* timeline, uint64_t value);
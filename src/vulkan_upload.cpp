@@ -0,0 +1,290 @@
+#include <string.h>
+#include "vulkan_upload.hpp"
+#include "vulkan_context.hpp"
+#include "vulkan_queue.hpp"
+
+Upload_Context create_upload_context(GpuIF gpu_if, Queue_Info queue, uint32_t dst_family, VkDeviceSize capacity, uint32_t frame_count) {
+	Upload_Context upload = {};
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu_if.gpu, &properties);
+	upload.alignment = properties.limits.optimalBufferCopyOffsetAlignment > 16 ? properties.limits.optimalBufferCopyOffsetAlignment : 16;
+	upload.capacity = EV_ALIGN_UP(capacity, upload.alignment);
+
+	upload.staging = create_bufferblock(gpu_if, upload.capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	bind_bufferblock(gpu_if, &upload.staging, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	upload.queue = queue;
+	upload.dst_family = dst_family;
+	upload.timeline = create_timeline(gpu_if);
+	upload.cmd_pool = create_command_pool(gpu_if, queue.family, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	upload.frame_count = frame_count;
+	upload.frames = EV_ALLOC(Upload_Frame, frame_count);
+
+	VkCommandBuffer* cmd_buffers = allocate_command_buffers(gpu_if, upload.cmd_pool, frame_count);
+	for (uint32_t x = 0; x < frame_count; x++) {
+		upload.frames[x].cmd_buffer = cmd_buffers[x];
+		upload.frames[x].value = 0;
+		upload.frames[x].ring_end = 0;
+		upload.frames[x].submitted = false;
+	}
+	EV_FREE(cmd_buffers);
+	return upload;
+}
+
+void destroy_upload_context(GpuIF gpu_if, Upload_Context* upload) {
+	timeline_wait(gpu_if, &upload->timeline, upload->timeline.value);
+	destroy_timeline(gpu_if, &upload->timeline);
+	vkDestroyCommandPool(gpu_if.device, upload->cmd_pool, NULL);
+	destroy_bufferblock(gpu_if, upload->staging);
+	EV_FREE(upload->frames);
+	EV_FREE(upload->buffer_copies);
+	EV_FREE(upload->image_copies);
+	EV_FREE(upload->buffer_acquires);
+	EV_FREE(upload->image_acquires);
+}
+
+static bool reclaim_oldest_frame(GpuIF gpu_if, Upload_Context* upload, bool wait) {
+	for (uint32_t x = 0; x < upload->frame_count; x++) {
+		Upload_Frame* frame = &upload->frames[(upload->frame_ix + x) % upload->frame_count];
+		if (!frame->submitted) continue;
+
+		if (wait) {
+			timeline_wait(gpu_if, &upload->timeline, frame->value);
+		}
+		else if (!timeline_reached(gpu_if, &upload->timeline, frame->value)) {
+			return false;
+		}
+		frame->submitted = false;
+		upload->tail = frame->ring_end;
+		return true;
+	}
+	return false;
+}
+
+static VkDeviceSize allocate_staging(GpuIF gpu_if, Upload_Context* upload, VkDeviceSize size) {
+	EV_CHECK(size <= upload->capacity);
+	while (reclaim_oldest_frame(gpu_if, upload, false));
+
+	for (;;) {
+		if (upload->head == upload->tail) {
+			upload->head = upload->tail = EV_ALIGN_UP(upload->head, upload->capacity);
+		}
+		uint64_t position = EV_ALIGN_UP(upload->head, upload->alignment);
+		if (position % upload->capacity + size > upload->capacity) {
+			position = EV_ALIGN_UP(position, upload->capacity);
+		}
+		if (position + size - upload->tail <= upload->capacity) {
+			upload->head = position + size;
+			return position % upload->capacity;
+		}
+		if (!reclaim_oldest_frame(gpu_if, upload, true)) {
+			flush_uploads(gpu_if, upload);
+		}
+	}
+}
+
+void* stage_buffer_upload(GpuIF gpu_if, Upload_Context* upload, VkBuffer dst, VkDeviceSize dst_offset, VkDeviceSize size) {
+	VkDeviceSize offset = allocate_staging(gpu_if, upload, size);
+
+	if (upload->buffer_copy_count == upload->buffer_copy_capacity) {
+		upload->buffer_copy_capacity = upload->buffer_copy_capacity ? upload->buffer_copy_capacity * 2 : 64;
+		upload->buffer_copies = EV_REALLOC(Buffer_Copy, upload->buffer_copies, upload->buffer_copy_capacity);
+	}
+	Buffer_Copy* copy = &upload->buffer_copies[upload->buffer_copy_count++];
+	copy->dst = dst;
+	copy->region = { offset, dst_offset, size };
+	return upload->staging.allocation.mapped + offset;
+}
+
+void* stage_image_upload(GpuIF gpu_if, Upload_Context* upload, VkImage dst, VkBufferImageCopy region, VkDeviceSize size, VkImageLayout final_layout) {
+	VkDeviceSize offset = allocate_staging(gpu_if, upload, size);
+
+	if (upload->image_copy_count == upload->image_copy_capacity) {
+		upload->image_copy_capacity = upload->image_copy_capacity ? upload->image_copy_capacity * 2 : 16;
+		upload->image_copies = EV_REALLOC(Image_Copy, upload->image_copies, upload->image_copy_capacity);
+	}
+	Image_Copy* copy = &upload->image_copies[upload->image_copy_count++];
+	copy->dst = dst;
+	copy->region = region;
+	copy->region.bufferOffset = offset;
+	copy->range.aspectMask = region.imageSubresource.aspectMask;
+	copy->range.baseMipLevel = region.imageSubresource.mipLevel;
+	copy->range.levelCount = 1;
+	copy->range.baseArrayLayer = region.imageSubresource.baseArrayLayer;
+	copy->range.layerCount = region.imageSubresource.layerCount;
+	copy->final_layout = final_layout;
+	return upload->staging.allocation.mapped + offset;
+}
+
+void upload_buffer(GpuIF gpu_if, Upload_Context* upload, BufferBlock dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size) {
+	void* staging = stage_buffer_upload(gpu_if, upload, dst.buffer, dst_offset, size);
+	memcpy(staging, data, size);
+}
+
+void upload_image(GpuIF gpu_if, Upload_Context* upload, ImageBlock dst, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout final_layout) {
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = extent;
+
+	void* staging = stage_image_upload(gpu_if, upload, dst.image, region, size, final_layout);
+	memcpy(staging, data, size);
+}
+
+static int compare_buffer_copies(const void* a, const void* b) {
+	VkBuffer dst_a = ((const Buffer_Copy*)a)->dst;
+	VkBuffer dst_b = ((const Buffer_Copy*)b)->dst;
+	return (dst_a > dst_b) - (dst_a < dst_b);
+}
+
+static bool is_same_subresource(Image_Copy* a, Image_Copy* b) {
+	return a->dst == b->dst && a->range.baseMipLevel == b->range.baseMipLevel && a->range.baseArrayLayer == b->range.baseArrayLayer;
+}
+
+static void record_image_barriers(Upload_Context* upload, VkCommandBuffer cmd_buffer, bool to_transfer) {
+	bool is_release = !to_transfer && upload->queue.family != upload->dst_family;
+	VkImageMemoryBarrier* barriers = EV_ALLOC(VkImageMemoryBarrier, upload->image_copy_count);
+	uint32_t barrier_count = 0;
+
+	for (uint32_t x = 0; x < upload->image_copy_count; x++) {
+		Image_Copy* copy = &upload->image_copies[x];
+		bool is_duplicate = false;
+		for (uint32_t y = 0; y < x && !is_duplicate; y++) {
+			is_duplicate = is_same_subresource(copy, &upload->image_copies[y]);
+		}
+		if (is_duplicate) continue;
+
+		VkImageMemoryBarrier* barrier = &barriers[barrier_count++];
+		*barrier = image_ownership_barrier(copy->dst, copy->range, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+		if (to_transfer) {
+			barrier->dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier->oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier->newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		}
+		else {
+			barrier->srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier->dstAccessMask = is_release ? 0 : VK_ACCESS_MEMORY_READ_BIT;
+			barrier->oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier->newLayout = copy->final_layout;
+		}
+		if (is_release) {
+			barrier->srcQueueFamilyIndex = upload->queue.family;
+			barrier->dstQueueFamilyIndex = upload->dst_family;
+			if (upload->image_acquire_count == upload->image_acquire_capacity) {
+				upload->image_acquire_capacity = upload->image_acquire_capacity ? upload->image_acquire_capacity * 2 : 16;
+				upload->image_acquires = EV_REALLOC(VkImageMemoryBarrier, upload->image_acquires, upload->image_acquire_capacity);
+			}
+			VkImageMemoryBarrier* acquire = &upload->image_acquires[upload->image_acquire_count++];
+			*acquire = *barrier;
+			acquire->srcAccessMask = 0;
+			acquire->dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		}
+	}
+
+	if (to_transfer) {
+		vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, barrier_count, barriers);
+	}
+	else {
+		VkPipelineStageFlags dst_stages = is_release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stages, 0, 0, NULL, 0, NULL, barrier_count, barriers);
+	}
+	EV_FREE(barriers);
+}
+
+static void release_buffer_copies(Upload_Context* upload, VkCommandBuffer cmd_buffer) {
+	if (upload->buffer_copy_count == 0) return;
+	VkBufferMemoryBarrier* barriers = EV_ALLOC(VkBufferMemoryBarrier, upload->buffer_copy_count);
+	if (upload->buffer_acquire_count + upload->buffer_copy_count > upload->buffer_acquire_capacity) {
+		upload->buffer_acquire_capacity = upload->buffer_acquire_count + upload->buffer_copy_count;
+		upload->buffer_acquires = EV_REALLOC(VkBufferMemoryBarrier, upload->buffer_acquires, upload->buffer_acquire_capacity);
+	}
+
+	for (uint32_t x = 0; x < upload->buffer_copy_count; x++) {
+		Buffer_Copy* copy = &upload->buffer_copies[x];
+		barriers[x] = buffer_ownership_barrier(copy->dst, copy->region.dstOffset, copy->region.size, upload->queue.family, upload->dst_family);
+		barriers[x].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		VkBufferMemoryBarrier* acquire = &upload->buffer_acquires[upload->buffer_acquire_count++];
+		*acquire = barriers[x];
+		acquire->srcAccessMask = 0;
+		acquire->dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+	}
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, upload->buffer_copy_count, barriers, 0, NULL);
+	EV_FREE(barriers);
+}
+
+uint32_t record_upload_acquires(Upload_Context* upload, VkCommandBuffer cmd_buffer, Semaphore_Point* wait) {
+	if (upload->acquire_value == 0) return 0;
+	vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL,
+		upload->buffer_acquire_count, upload->buffer_acquires, upload->image_acquire_count, upload->image_acquires);
+
+	*wait = timeline_point(&upload->timeline, upload->acquire_value, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	upload->buffer_acquire_count = 0;
+	upload->image_acquire_count = 0;
+	upload->acquire_value = 0;
+	return 1;
+}
+
+void flush_uploads(GpuIF gpu_if, Upload_Context* upload) {
+	if (upload->buffer_copy_count == 0 && upload->image_copy_count == 0) return;
+
+	Upload_Frame* frame = &upload->frames[upload->frame_ix];
+	timeline_wait(gpu_if, &upload->timeline, frame->value);
+	if (frame->submitted) {
+		frame->submitted = false;
+		upload->tail = frame->ring_end;
+	}
+
+	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	EV_CHECK_VKRESULT(vkBeginCommandBuffer(frame->cmd_buffer, &begin_info));
+
+	qsort(upload->buffer_copies, upload->buffer_copy_count, sizeof(Buffer_Copy), compare_buffer_copies);
+	VkBufferCopy* regions = EV_ALLOC(VkBufferCopy, upload->buffer_copy_count);
+	for (uint32_t x = 0; x < upload->buffer_copy_count;) {
+		VkBuffer dst = upload->buffer_copies[x].dst;
+		uint32_t region_count = 0;
+		for (; x < upload->buffer_copy_count && upload->buffer_copies[x].dst == dst; x++) {
+			regions[region_count++] = upload->buffer_copies[x].region;
+		}
+		vkCmdCopyBuffer(frame->cmd_buffer, upload->staging.buffer, dst, region_count, regions);
+	}
+	EV_FREE(regions);
+
+	if (upload->image_copy_count) {
+		record_image_barriers(upload, frame->cmd_buffer, true);
+		for (uint32_t x = 0; x < upload->image_copy_count; x++) {
+			Image_Copy* copy = &upload->image_copies[x];
+			vkCmdCopyBufferToImage(frame->cmd_buffer, upload->staging.buffer, copy->dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy->region);
+		}
+		record_image_barriers(upload, frame->cmd_buffer, false);
+	}
+
+	frame->value = timeline_advance(&upload->timeline);
+	Semaphore_Point signal = timeline_point(&upload->timeline, frame->value, 0);
+	Queue_Submit submit = {};
+	submit.cmd_buffers = &frame->cmd_buffer;
+	submit.cmd_buffer_count = 1;
+	submit.signals = &signal;
+	submit.signal_count = 1;
+	if (upload->queue.family != upload->dst_family) {
+		release_buffer_copies(upload, frame->cmd_buffer);
+		upload->acquire_value = frame->value;
+	}
+	else {
+		VkMemoryBarrier memory_barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memory_barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(frame->cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memory_barrier, 0, NULL, 0, NULL);
+	}
+	EV_CHECK_VKRESULT(vkEndCommandBuffer(frame->cmd_buffer));
+	submit_queue(upload->queue.queue, submit, VK_NULL_HANDLE);
+
+	frame->ring_end = upload->head;
+	frame->submitted = true;
+	upload->frame_ix = (upload->frame_ix + 1) % upload->frame_count;
+	upload->buffer_copy_count = 0;
+	upload->image_copy_count = 0;
+}
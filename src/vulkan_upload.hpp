@@ -0,0 +1,70 @@
+#pragma once
+
+#include "vulkan_dispatch.hpp"
+#include "utils.hpp"
+#include "vulkan_structs.hpp"
+#include "vulkan_resource.hpp"
+#include "vulkan_timeline.hpp"
+
+struct Buffer_Copy
+{
+	VkBuffer dst;
+	VkBufferCopy region;
+};
+
+struct Image_Copy
+{
+	VkImage dst;
+	VkBufferImageCopy region;
+	VkImageSubresourceRange range;
+	VkImageLayout final_layout;
+};
+
+struct Upload_Frame
+{
+	VkCommandBuffer cmd_buffer;
+	uint64_t value;
+	uint64_t ring_end;
+	bool submitted;
+};
+
+struct Upload_Context
+{
+	BufferBlock staging;
+	VkDeviceSize capacity;
+	VkDeviceSize alignment;
+	uint64_t head;
+	uint64_t tail;
+
+	Buffer_Copy* buffer_copies;
+	uint32_t buffer_copy_count;
+	uint32_t buffer_copy_capacity;
+	Image_Copy* image_copies;
+	uint32_t image_copy_count;
+	uint32_t image_copy_capacity;
+
+	Queue_Info queue;
+	uint32_t dst_family;
+	Timeline timeline;
+	uint64_t acquire_value;
+	VkBufferMemoryBarrier* buffer_acquires;
+	uint32_t buffer_acquire_count;
+	uint32_t buffer_acquire_capacity;
+	VkImageMemoryBarrier* image_acquires;
+	uint32_t image_acquire_count;
+	uint32_t image_acquire_capacity;
+
+	VkCommandPool cmd_pool;
+	Upload_Frame* frames;
+	uint32_t frame_count;
+	uint32_t frame_ix;
+};
+
+Upload_Context create_upload_context(GpuIF gpu_if, Queue_Info queue, uint32_t dst_family, VkDeviceSize capacity, uint32_t frame_count);
+void destroy_upload_context(GpuIF gpu_if, Upload_Context* upload);
+void* stage_buffer_upload(GpuIF gpu_if, Upload_Context* upload, VkBuffer dst, VkDeviceSize dst_offset, VkDeviceSize size);
+void* stage_image_upload(GpuIF gpu_if, Upload_Context* upload, VkImage dst, VkBufferImageCopy region, VkDeviceSize size, VkImageLayout final_layout);
+void upload_buffer(GpuIF gpu_if, Upload_Context* upload, BufferBlock dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size);
+void upload_image(GpuIF gpu_if, Upload_Context* upload, ImageBlock dst, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout final_layout);
+void flush_uploads(GpuIF gpu_if, Upload_Context* upload);
+uint32_t record_upload_acquires(Upload_Context* upload, VkCommandBuffer cmd_buffer, Semaphore_Point* wait);